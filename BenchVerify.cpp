@@ -0,0 +1,223 @@
+// Сверки cubeBench --verify без замеров времени (замеры - в bench.cpp).
+// ctest гоняет их на маленьком регионе, см. CMakeLists.txt.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Definitions/Core/Config.h"
+#include "Definitions/Core/Constants.hpp"
+#include "BenchVerify.hpp"
+
+import Chunk;
+import ChunkGenerationSystem;
+import ChunkMesher;
+import LockFreeQueue;
+import JobSystem;
+import TerrainKernels;
+
+// Сверка апскейлера с эталоном на реальном шуме региона и на случайных данных.
+// Сравнение через ==, поэтому -0.0f и +0.0f считаются равными.
+bool verifyUpscale(const std::vector<glm::ivec3>& region) {
+    std::vector<float> lowRes(NOISE_LR_SIZE);
+    std::vector<float> reference(NOISE_HR_SIZE), simd(NOISE_HR_SIZE);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    uint64_t mismatches = 0;
+    size_t inputs = std::min<size_t>(region.size(), 256);
+    for (size_t n = 0; n < inputs + 64; ++n) {
+        if (n < inputs) generateLowResNoise(region[n], lowRes.data());
+        else for (auto& v : lowRes) v = dist(rng);
+
+        upscaleNoiseScalar(lowRes.data(), reference.data());
+        upscaleNoise(lowRes.data(), simd.data());
+        for (int i = 0; i < NOISE_HR_SIZE; ++i) mismatches += reference[i] != simd[i];
+    }
+
+    std::cout << "upscale  mismatches=" << mismatches << "\n";
+    return mismatches == 0;
+}
+
+// Сверка раскраски блоков (SIMD-линии против веток) на шуме региона.
+bool verifyClassify(const std::vector<glm::ivec3>& region) {
+    std::vector<float> lowRes(NOISE_LR_SIZE), highRes(NOISE_HR_SIZE);
+    std::vector<uint8_t> reference(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z);
+    std::vector<uint8_t> simd(reference.size());
+
+    uint64_t mismatches = 0;
+    size_t inputs = std::min<size_t>(region.size(), 256);
+    for (size_t n = 0; n < inputs; ++n) {
+        generateLowResNoise(region[n], lowRes.data());
+        upscaleNoiseScalar(lowRes.data(), highRes.data());
+
+        int startY = region[n].y * CHUNK_SIZE_Y;
+        classifyBlocksScalar(highRes.data(), startY, SEA_LEVEL, reference.data());
+        classifyBlocks(highRes.data(), startY, SEA_LEVEL, simd.data());
+        for (size_t i = 0; i < reference.size(); ++i) mismatches += reference[i] != simd[i];
+    }
+
+    std::cout << "classify mismatches=" << mismatches << " (" << classifyBlocksArch() << ")\n";
+    return mismatches == 0;
+}
+
+// Сверка битового мешера со скалярным: выход должен совпадать побайтно.
+// Проверяются сгенерированные чанки региона и случайные чанки 3x3x3 (в том числе с 255 типами).
+bool verifyMesher(const std::vector<std::shared_ptr<Chunk>>& generated, const ChunkMap& map) {
+    uint64_t mismatches = 0, checked = 0;
+
+    auto compare = [&](const Chunk* chunk, const ChunkMap& chunks) {
+        mismatches += BuildChunkMesh(chunk, chunks, MesherType::Scalar) != BuildChunkMesh(chunk, chunks, MesherType::Binary);
+        ++checked;
+    };
+
+    for (const auto& chunk : generated) compare(chunk.get(), map);
+
+    std::mt19937 rng(777);
+    for (int n = 0; n < 32; ++n) {
+        ChunkMap randomMap;
+        const int kinds = (n % 4 == 3) ? 256 : 2 + n % 4;
+        const int airChance = 1 + n % 3; // 1/2, 1/3, 1/4 воздуха
+        for (int x = -1; x <= 1; ++x)
+            for (int y = -1; y <= 1; ++y)
+                for (int z = -1; z <= 1; ++z) {
+                    auto chunk = std::make_shared<Chunk>(glm::ivec3(x, y, z));
+                    for (int i = 0; i < CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z; ++i)
+                        chunk->data()[i] = (rng() % (airChance + 1) == 0) ? BLOCK_AIR : static_cast<uint8_t>(1 + rng() % (kinds - 1));
+                    randomMap.insert(glm::ivec3(x, y, z), chunk);
+                }
+        compare(randomMap.tryGet(glm::ivec3(0, 0, 0)).get(), randomMap);
+    }
+
+    std::cout << "mesher   mismatches=" << mismatches << "/" << checked << "\n";
+    return mismatches == 0;
+}
+
+// Стресс очередей без блокировок: несколько производителей гонят пронумерованные
+// элементы через маленькое кольцо (чтобы постоянно упираться в переполнение),
+// потребитель проверяет, что ничего не потеряно и порядок каждого производителя
+// сохранен. Плюс MPMC с двумя потребителями и SPSC.
+bool verifyQueues() {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 50000;
+    bool ok = true;
+
+    // MPSC (как voxelDataQueue/uploadQueue): shared_ptr, чтобы ловить двойные освобождения
+    {
+        MpmcQueue<std::shared_ptr<int>> queue(64);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&queue, p] {
+                for (int i = 0; i < PER_PRODUCER; ++i) queue.push(std::make_shared<int>(p * PER_PRODUCER + i));
+            });
+        }
+        std::vector<int> last(PRODUCERS, -1);
+        std::vector<std::shared_ptr<int>> batch;
+        int received = 0;
+        while (received < PRODUCERS * PER_PRODUCER) {
+            batch.clear();
+            if (queue.popBatch(batch, 128) == 0) std::this_thread::yield();
+            for (const auto& item : batch) {
+                const int p = *item / PER_PRODUCER, i = *item % PER_PRODUCER;
+                if (i != last[p] + 1) ok = false;
+                last[p] = i;
+                ++received;
+            }
+        }
+        for (auto& t : producers) t.join();
+        const QueueStats st = queue.stats();
+        ok = ok && st.pushed == st.popped && st.depth == 0;
+        std::cout << "queue mpsc: items=" << st.popped << " maxDepth=" << st.maxDepth
+                  << " fullWaits=" << st.fullWaits << " wait=" << std::fixed << std::setprecision(1)
+                  << st.waitUs / 1000.0 << "ms" << (ok ? "" : " FAILED") << "\n";
+    }
+
+    // MPMC: два потребителя, проверка по сумме
+    {
+        MpmcQueue<int64_t> queue(128);
+        std::atomic<int64_t> sum{0}, received{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            threads.emplace_back([&queue] { for (int64_t i = 1; i <= PER_PRODUCER; ++i) queue.push(int64_t(i)); });
+        }
+        for (int c = 0; c < 2; ++c) {
+            threads.emplace_back([&] {
+                int64_t v;
+                while (received.load() < int64_t(PRODUCERS) * PER_PRODUCER) {
+                    if (queue.tryPop(v)) { sum += v; ++received; }
+                    else std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        const bool sumOk = sum == int64_t(PRODUCERS) * PER_PRODUCER * (PER_PRODUCER + 1) / 2;
+        ok = ok && sumOk;
+        std::cout << "queue mpmc: " << (sumOk ? "ok" : "FAILED") << "\n";
+    }
+
+    // SPSC (как unloadQueue): строгий порядок
+    {
+        SpscQueue<glm::ivec3> queue(16);
+        std::thread producer([&queue] {
+            for (int i = 0; i < PER_PRODUCER; ++i) queue.push(glm::ivec3(i, -i, i));
+        });
+        bool orderOk = true;
+        glm::ivec3 v;
+        for (int i = 0; i < PER_PRODUCER;) {
+            if (!queue.tryPop(v)) { std::this_thread::yield(); continue; }
+            if (v != glm::ivec3(i, -i, i)) orderOk = false;
+            ++i;
+        }
+        producer.join();
+        ok = ok && orderOk;
+        std::cout << "queue spsc: " << (orderOk ? "ok" : "FAILED") << " fullWaits=" << queue.stats().fullWaits << "\n";
+    }
+    return ok;
+}
+
+// Ленивый пересчет ключей: один воркер занят, пока в очередь кладутся задачи
+// вдоль оси X, затем игрок "перелетает" в конец ряда. Задачи за радиусом отмены
+// должны отмениться, остальные - выполниться ровно по разу.
+bool verifyJobRekey() {
+    auto& jobs = JobSystem::Get();
+    jobs.start(1);
+    jobs.setView(glm::ivec3(0), glm::vec3(0, 0, -1));
+    jobs.setCancelRadius(JobClass::Generation, 4.0f);
+
+    std::atomic<bool> release{false};
+    jobs.submit(JobClass::IO, [&release] { while (!release) std::this_thread::yield(); });
+    while (jobs.pending(JobClass::IO) > 0) std::this_thread::yield(); // Воркер занят блокером
+
+    constexpr int ROW = 9;
+    std::vector<int> order;
+    std::vector<int> ran(ROW, 0), cancelled(ROW, 0);
+    for (int x = 0; x < ROW; ++x) {
+        jobs.submit(JobClass::Generation, glm::ivec3(x, 0, 0),
+                    [&, x] { order.push_back(x); ran[x]++; },
+                    [&, x] { cancelled[x]++; });
+    }
+    // Ключи x = 5..8 посчитаны как "за радиусом" - лежат в последней корзине
+    jobs.setView(glm::ivec3(ROW - 1, 0, 0), glm::vec3(1, 0, 0));
+    release = true;
+    jobs.waitIdle();
+    const JobQueueStats q = jobs.queueStats();
+    jobs.stop();
+
+    bool ok = true;
+    for (int x = 0; x < ROW; ++x) {
+        const bool outside = (ROW - 1 - x) > 4;
+        ok = ok && ran[x] == (outside ? 0 : 1) && cancelled[x] == (outside ? 1 : 0);
+    }
+    std::cout << "job rekey: order";
+    for (int x : order) std::cout << " " << x;
+    std::cout << " rekeyed=" << q.rekeyed << " demoted=" << q.demoted << " cancelled=" << q.cancelled
+              << (ok ? "" : " FAILED") << "\n";
+    return ok;
+}
@@ -0,0 +1,20 @@
+// Сверки cubeBench --verify, отделенные от замеров: SIMD-ядра против скалярного
+// эталона, битовый мешер против скалярного, очереди без блокировок и пересчет
+// ключей JobSystem. Каждая печатает строку итогов и возвращает false при расхождении.
+
+#ifndef BENCH_VERIFY_HPP
+#define BENCH_VERIFY_HPP
+
+#include <memory>
+#include <vector>
+#include <glm/vec3.hpp>
+
+import Chunk;
+
+bool verifyUpscale(const std::vector<glm::ivec3>& region);
+bool verifyClassify(const std::vector<glm::ivec3>& region);
+bool verifyMesher(const std::vector<std::shared_ptr<Chunk>>& generated, const ChunkMap& map);
+bool verifyQueues();
+bool verifyJobRekey();
+
+#endif // BENCH_VERIFY_HPP
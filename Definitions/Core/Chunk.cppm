@@ -2,6 +2,7 @@
 module;
 
 #include <vector>
+#include <atomic>
 #include <cstdint>
 #include <memory>        // std::shared_ptr
 #include <unordered_map> // std::unordered_map
@@ -36,12 +37,38 @@ export struct FastIVec3Equal {
 export using ChunkMap = ShardedMap<glm::ivec3, std::shared_ptr<class Chunk>, GoodVec3Hasher, FastIVec3Equal>;
 export using ChunkSet = ShardedSet<glm::ivec3, GoodVec3Hasher, FastIVec3Equal>;
 
+// Палитровое хранение блоков: палитра ID + индексы по 1/2/4 бита,
+// упакованные в 64-битные слова (индекс не пересекает границу слова).
+export struct PalettedBlocks {
+    std::vector<uint8_t> palette; // индекс -> ID блока
+    std::vector<uint64_t> words;
+    uint8_t bits = 0;             // 1, 2 или 4 (больше 16 видов блоков не упаковываются)
+
+    [[nodiscard]] uint8_t get(int index) const;
+    // Распаковывает 32 подряд идущих блока (одну строку X), начиная с index
+    void decodeRow(int index, uint8_t* dst) const;
+    [[nodiscard]] size_t memoryBytes() const;
+};
+
 // Сам класс Chunk
+// Три режима хранения, проверяются в таком порядке:
+//   blocks != nullptr -> плоский буфер (нужен для правок);
+//   packed            -> палитра (paletteStorage в Config.h);
+//   иначе             -> однородный чанк (uniformBlock).
 export class Chunk {
 public:
     glm::ivec3 worldPosition;
-    uint8_t* blocks = nullptr;
+    // Плоский буфер 32^3 (x + y*32 + z*1024) из ChunkAllocator.
+    // Атомарный: expand() может подменить его, пока мешер в другом потоке читает чанк.
+    // Читать через data() (acquire), а не напрямую.
+    std::atomic<uint8_t*> blocks{nullptr};
+    // Палитровое представление. После expand() остается жить до смерти чанка:
+    // мешер в другом потоке мог уже начать читать из него.
+    std::unique_ptr<PalettedBlocks> packed;
+    uint8_t uniformBlock = 0;
     bool needsMeshUpdate = false;
+    uint8_t meshLod = 0; // LOD последнего поставленного в мешинг меша (ChunkLod), главный поток
+    uint8_t genLod = 0;  // Блоки сгенерированы прореженными (ячейки lodScale(genLod)): мешить не детальнее
 
     // void* лучше, чем зависимость от GL заголовков в модуле, если можно избежать
     void* renderInfo = nullptr;
@@ -50,10 +77,39 @@ public:
     // Mutex не копируется, поэтому аккуратнее с конструкторами копирования
     // std::mutex mutex; // <mutex> нужно подключить в module; наверху
 
+    // Чанк с буфером (содержимое не инициализировано)
     explicit Chunk(glm::ivec3 pos);
+    // Однородный чанк без буфера (воздух над рельефом, сплошной камень и т.п.)
+    Chunk(glm::ivec3 pos, uint8_t block);
     ~Chunk();
 
+    // Плоский буфер или nullptr. Acquire в паре с release в expand(): увидели указатель -
+    // видим и разложенные в буфер блоки.
+    [[nodiscard]] uint8_t* data() const { return blocks.load(std::memory_order_acquire); }
+    [[nodiscard]] bool isUniform() const { return data() == nullptr && !packed; }
+    [[nodiscard]] bool isPacked() const { return data() == nullptr && packed; }
     [[nodiscard]] uint8_t get(int x, int y, int z) const;
+
+    // Строка X (32 блока) по (y, z) в dst, в любом режиме хранения, без разворачивания
+    void copyRow(int y, int z, uint8_t* dst) const;
+
+    // Запись блока. Однородный или палитровый чанк при первой записи разворачивается в буфер.
+    void set(int x, int y, int z, uint8_t block);
+
+    // Гарантирует плоский буфер (разворачивает однородный/палитровый чанк)
+    uint8_t* expand();
+
+    // Если все блоки одинаковые - возвращает буфер в аллокатор. true, если свернули.
+    bool compactIfUniform();
+
+    // Плоский буфер -> палитра (или однородный чанк). Если блоков больше 16 видов,
+    // остается плоским: 8-битной ширины нет, байт на индекс плюс палитра не меньше
+    // самого буфера. Генерация дает 4 вида, больше - только после правок.
+    // true, если сжали.
+    bool compress();
+
+    // Сколько памяти занимают блоки чанка (для отчетов)
+    [[nodiscard]] size_t memoryBytes() const;
 };
 
 // Экспорт функций
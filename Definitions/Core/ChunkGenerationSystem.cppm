@@ -1,11 +1,13 @@
 module;
-#include <condition_variable>
-#include <queue>
 #include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <memory>
+#include <vector>
 #include <glm/vec3.hpp>
 import Chunk;
+import ChunkGrid;
+import LockFreeQueue;
 
 export module ChunkGenerationSystem;
 
@@ -13,31 +15,19 @@ export module ChunkGenerationSystem;
 
 
 
-// Структура задачи для генерации
-export struct ChunkGenerationTask {
-    glm::ivec3 chunkPos;
-    float distToPlayerSq; // Дистанция в квадрате
-
-    // Приоритетная очередь: min dist -> top
-    bool operator<(const ChunkGenerationTask& other) const {
-        return distToPlayerSq > other.distToPlayerSq;
-    }
-};
-
-
-// 1. Очередь ЗАДАЧ НА ГЕНЕРАЦИЮ (позиции)
-export std::priority_queue<ChunkGenerationTask> generationQueue;
-export ChunkSet pendingGeneration; // Чтобы не добавлять дубликаты
+// 1. Чанки, поставленные в JobSystem на генерацию (чтобы не добавлять дубликаты)
+export ChunkSet pendingGeneration;
 export std::mutex generationMutex;
-export std::condition_variable generationCV;
 
 // 2. Очередь ГОТОВЫХ ДАННЫХ (сгенерированные чанки ждут отправки в ChunkMap)
-export std::queue<std::shared_ptr<Chunk>> voxelDataQueue;
-export std::mutex voxelDataMutex;
+// Воркеры -> главный поток, без блокировок
+export constexpr size_t VOXEL_QUEUE_CAPACITY = 4096;
+export MpmcQueue<std::shared_ptr<Chunk>> voxelDataQueue{VOXEL_QUEUE_CAPACITY};
 
 // 3. Очередь НА ВЫГРУЗКУ (позиции для удаления)
-export std::queue<glm::ivec3> unloadQueue;
-export std::mutex unloadMutex;
+// Поисковик -> главный поток: ровно один производитель и один потребитель
+export constexpr size_t UNLOAD_QUEUE_CAPACITY = 16384;
+export SpscQueue<glm::ivec3> unloadQueue{UNLOAD_QUEUE_CAPACITY};
 
 // 4. Состояние
 export std::atomic<bool> running{true};
@@ -46,14 +36,69 @@ export std::mutex playerPosMutex;
 
 export constexpr int SEA_LEVEL = 16;
 
+// Прямо из сетки шума генерируются LOD 1 и 2 (ячейки 2 и 4 блока): узлы этих
+// сеток совпадают с узлами lowResNoise. Дальше сетка слишком редкая для рельефа.
+export constexpr int GENERATION_LOD_MAX = 2;
+
+// Счетчики работы поисковика (пишет только его поток, читать можно откуда угодно)
+export struct FinderStats {
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> boundaryCrossings{0}; // Переходы игрока в другой чанк
+    std::atomic<uint64_t> slabPositions{0};     // Позиций просмотрено в слоях входа/выхода
+    std::atomic<uint64_t> loadRequests{0};
+    std::atomic<uint64_t> unloadRequests{0};
+    std::atomic<uint64_t> fullSweeps{0};        // Медленные сверки с картой
+    std::atomic<uint64_t> requeued{0};          // Отмененные JobSystem и поставленные заново
+    std::atomic<uint32_t> lastTickUs{0};
+    std::atomic<uint32_t> pendingLoads{0};      // Кандидатов на загрузку
+    std::atomic<uint32_t> unloadCandidates{0};  // Кандидатов на выгрузку
+};
+export FinderStats finderStats;
+
 // --- Функции ---
 
 // Генерирует воксельные данные (возвращает готовый чанк)
-std::shared_ptr<Chunk> generateChunkData(const glm::ivec3& chunkPos);
-
-// Поток-работник: берет позицию из generationQueue -> генерирует -> в voxelDataQueue
-export void chunkWorker();
+// Экспортируется для cubeBench: генерация не требует окна и GL.
+// lod > 0 - прореженный чанк прямо из сетки шума (classifyBlocksCoarse, не грубее
+// GENERATION_LOD_MAX): мешить его можно только с LOD не меньше Chunk::genLod.
+// Полный чанк - через generateColumnData(chunkPos, 1, ...): с остатком земли
+// от чанка выше (по трем нижним узлам его шума), блок в блок как в стопке.
+export std::shared_ptr<Chunk> generateChunkData(const glm::ivec3& chunkPos, int lod = 0);
+
+// Заполняет сетку шума низкого разрешения (NOISE_LR_SIZE float'ов) для чанка.
+export void generateLowResNoise(const glm::ivec3& chunkPos, float* out);
+
+// Сетка шума с шагом step блоков (coarseNoiseSize(step) float'ов). Шаг 2 - те же
+// узлы, что у generateLowResNoise, шаг 4 - каждый второй из них.
+export void generateCoarseNoise(const glm::ivec3& chunkPos, int step, float* out);
+
+// Стопка чанков bottom + (0, i, 0), i < count (count <= 64), из одной сетки шума:
+// один вызов GenUniformGrid3D на всю высоту вместо count вызовов по 18 слоев.
+// Нужны только чанки с битом i в mask (остальные уже загружены), но раскраска
+// идет сверху вниз и несет остаток земли через границы чанков: над каждым полным
+// чанком, чей верхний сосед не раскрашивается полностью (выше стопки, уже
+// загружен или прореженный), остаток считается по нижним узлам соседа.
+// lods[i] - LOD генерации чанка i (nullptr - все полные); прореженные чанки
+// берут узлы из той же сетки. Полные чанки совпадают с generateChunkData
+// блок в блок при любых lods. Готовые чанки - в out, сверху вниз.
+export void generateColumnData(const glm::ivec3& bottom, int count, uint64_t mask, const uint8_t* lods,
+                               std::vector<std::shared_ptr<Chunk>>& out);
+
+// Задача JobSystem (класс Generation): генерирует чанк -> в voxelDataQueue.
+// Ставится с ключом-чанком: JobSystem пересчитывает приоритет по мере движения
+// игрока и отменяет задачу за радиусом отмены (renderDistanceXZ + 2).
+// LOD генерации выбирается по кольцу в момент выполнения; full - всегда полная.
+export void generateChunkJob(const glm::ivec3& chunkPos, bool full = false);
+
+// Задача JobSystem для стопки (columnGeneration): generateColumnData -> в voxelDataQueue.
+// LOD каждого чанка выбирается по кольцу в момент выполнения.
+export void generateColumnJob(const glm::ivec3& bottom, int count, uint64_t mask);
+
+// Чанк сгенерирован прореженным, а игрок подошел: ставит полную генерацию.
+// Готовый чанк придет через voxelDataQueue и заменит прореженный.
+// false - на эту позицию уже стоит задача.
+export bool requestFullGeneration(const glm::ivec3& chunkPos);
 
 // Поток-поисковик: ищет, какие чанки загрузить/выгрузить, обновляет очереди
-// Принимает ссылку на ТЕКУЩУЮ карту чанков для проверки существования
-export void chunkFinder(const ChunkMap& chunks);
+// Принимает ссылку на ТЕКУЩУЮ карту чанков и сетку (проверка существования без блокировок)
+export void chunkFinder(const ChunkMap& chunks, const ChunkGrid& grid);
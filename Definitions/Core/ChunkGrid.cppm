@@ -0,0 +1,138 @@
+module;
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/vec3.hpp>
+
+import Chunk;
+export module ChunkGrid;
+
+// Плотная тороидальная сетка загруженных чанков вокруг игрока.
+// Слот = координата чанка по модулю размеров сетки (степени двойки), поэтому при
+// движении игрока ничего не переезжает: меняется только центр окна.
+//
+// Читатели (мешер, физика, поисковик) не берут блокировок: один atomic load
+// и сравнение worldPosition (в слоте мог остаться чанк, совпадающий по модулю).
+// Писатель один - главный поток (publish/remove/setCenter/collectRetired).
+//
+// Освобождение - по эпохам: читатель держит ReadGuard, пока пользуется сырыми
+// указателями из сетки, и на входе объявляет текущую эпоху. Убранный из сетки
+// чанк помечается эпохой убирания и отпускается, когда все активные читатели
+// вошли позже (значит, уже не могли его увидеть). Сколько бы читатель ни был
+// вытеснен, чанк под ним живой; кадры и время тут ни при чем.
+
+// Запас окна сверх радиуса загрузки (выгрузка срабатывает на радиусе + 2)
+export constexpr int GRID_MARGIN = 3;
+// Потоков-читателей одновременно (слот занимается при первом ReadGuard потока)
+export constexpr int GRID_READER_SLOTS = 128;
+
+// Коробка позиций чанков, включительно. lo > hi по любой оси - пустая.
+export struct ChunkBox {
+    glm::ivec3 lo, hi;
+};
+
+// Позиции to без from: до трех непересекающихся слоев (X, затем Y, затем Z).
+// При сдвиге на один чанк это одна грань коробки, а не вся коробка.
+export void boxDifference(const ChunkBox& from, const ChunkBox& to, std::vector<glm::ivec3>& out);
+
+export class ChunkGrid {
+public:
+    ChunkGrid(int radiusXZ, int radiusY);
+
+    // Читатель вне главного потока держит его, пока пользуется указателями из
+    // tryGet. Вложенные guard'ы одного потока - один вход. Не переносится между потоками.
+    class ReadGuard {
+    public:
+        ReadGuard();
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    // --- Писатель (только главный поток) ---
+
+    // Переносит окно на center (чанк игрока). Пока работает publishEntered,
+    // читатели видят пересечение старого и нового окна: в нем слоты не меняются,
+    // а вошедшие и вышедшие позиции для них "вне окна" (идут в карту).
+    // publishEntered(entered) публикует чанки вошедших позиций - слой разности
+    // окон, а не вся карта (publish проверяет уже новое окно).
+    template <typename F>
+    void setCenter(const glm::ivec3& center, F&& publishEntered) {
+        const Box next = windowAround(center);
+        const Box kept = intersect(target, next); // До первого вызова target пуст - пересечение тоже
+        entered.clear();
+        boxDifference(kept, next, entered);
+        storeWindow(kept);
+        target = next;
+        publishEntered(static_cast<const std::vector<glm::ivec3>&>(entered));
+        storeWindow(target);
+    }
+    void setCenter(const glm::ivec3& center) { setCenter(center, [](const std::vector<glm::ivec3>&) {}); }
+
+    // Публикует чанк в его слот. Чанк вне окна не публикуется (false).
+    // Занятый чужим чанком слот отдается новому, если старый уже вне окна.
+    bool publish(const std::shared_ptr<Chunk>& chunk);
+
+    // Убирает чанк из слота (если там именно он)
+    void remove(const Chunk* chunk);
+
+    // Конец кадра: отпускает убранные чанки, которые уже не видит ни один читатель
+    void collectRetired();
+
+    // --- Читатели (любой поток, без блокировок) ---
+
+    [[nodiscard]] bool inWindow(const glm::ivec3& pos) const;
+
+    // Чанк по координате или nullptr. Внутри окна ответ окончательный
+    // (nullptr = не загружен), вне окна - "неизвестно".
+    // Вне главного потока - только под ReadGuard.
+    [[nodiscard]] Chunk* tryGet(const glm::ivec3& pos) const {
+        Chunk* chunk = slots[slotIndex(pos)].load(std::memory_order_acquire);
+        return (chunk && chunk->worldPosition == pos) ? chunk : nullptr;
+    }
+
+    // Загружен ли чанк: внутри окна - сетка, вне окна - карта
+    [[nodiscard]] bool contains(const glm::ivec3& pos, const ChunkMap& map) const;
+
+    [[nodiscard]] glm::ivec3 getDims() const { return {dimX, dimY, dimZ}; }
+
+private:
+    // Окно включительно. lo > hi - пустое (до первого setCenter).
+    using Box = ChunkBox;
+
+    int dimX, dimY, dimZ;
+    int maskX, maskY, maskZ;
+
+    // Окно для читателей под seqlock'ом: нечетный windowSeq - идет запись
+    std::atomic<uint32_t> windowSeq{0};
+    std::atomic<int> windowLo[3], windowHi[3];
+    Box target{glm::ivec3(1), glm::ivec3(0)}; // Окно писателя (publish)
+    std::vector<glm::ivec3> entered;          // Вошедшие позиции последнего setCenter
+
+    std::unique_ptr<std::atomic<Chunk*>[]> slots;
+    std::vector<std::shared_ptr<Chunk>> owners; // Владение опубликованными (только писатель)
+
+    struct Retired {
+        std::shared_ptr<Chunk> chunk;
+        uint64_t epoch; // Эпоха, в которой чанк убран из слота
+    };
+    std::vector<Retired> retired;
+
+    [[nodiscard]] size_t slotIndex(const glm::ivec3& pos) const {
+        return static_cast<size_t>(pos.x & maskX)
+             + static_cast<size_t>(pos.y & maskY) * dimX
+             + static_cast<size_t>(pos.z & maskZ) * dimX * dimY;
+    }
+
+    [[nodiscard]] Box windowAround(const glm::ivec3& center) const;
+    [[nodiscard]] static Box intersect(const Box& a, const Box& b);
+    [[nodiscard]] static bool inBox(const Box& box, const glm::ivec3& pos);
+    void storeWindow(const Box& box);
+
+    void retire(size_t slot);
+};
+
+// Блок по мировым координатам через сетку (вне окна - через карту). 0 - нет чанка.
+export uint8_t getBlock(glm::vec3 worldPos, const ChunkGrid& grid, const ChunkMap& chunks);
+export bool isSolidBlock(glm::vec3 pos, const ChunkGrid& grid, const ChunkMap& chunks);
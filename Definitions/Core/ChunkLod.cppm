@@ -0,0 +1,39 @@
+module;
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+#include "Config.h"
+
+import PaddedVolume;
+export module ChunkLod;
+
+// LOD дальних чанков. Объем чанка прореживается ячейками 2, 4 или 8 блоков
+// (каждая ячейка - один блок, см. LodReduction) и мешится тем же greedy-мешером:
+// грани бывают только на границах ячеек, поэтому квадов в s^2 раз меньше,
+// а формат квадов и шейдеры не меняются (квады по-прежнему в блоках).
+//
+// LOD выбирается по кольцу (расстояние Чебышева в чанках до чанка игрока):
+// LOD k начинается с кольца lodStartDistance * 2^(k-1). Обратно на более
+// детальный LOD чанк переходит только на lodHysteresis колец ближе - игрок,
+// шагающий по границе колец, не гоняет перемешивание туда-обратно.
+//
+// Стыки соседних LOD не сшиваются (щели на рельефе вдали почти не видны).
+
+export constexpr int LOD_MAX = 3; // 2x, 4x, 8x
+
+// Ребро ячейки LOD в блоках
+export constexpr int lodScale(int lod) { return 1 << lod; }
+
+// Кольцо чанка относительно чанка игрока
+export int chunkRing(const glm::ivec3& chunk, const glm::ivec3& center);
+
+// Первое кольцо LOD lod (lod >= 1)
+export int lodStartRing(int lod);
+
+// LOD для кольца ring, если сейчас чанк смешан в current (новый чанк - 0)
+export int selectLod(int ring, int current);
+
+// Прореживает центр 32^3 ячейками lodScale(lod) (ячейка заполняется одним блоком)
+// и рамку квадратами того же размера. Рамка считается сплошной, только если
+// сплошной весь квадрат: лишняя грань на стыке дешевле дыры в рельефе.
+export void downsampleVolume(PaddedVolume& volume, int lod, LodReduction mode);
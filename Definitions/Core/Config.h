@@ -17,8 +17,30 @@ struct ChunkMetadata {
     uint32_t instanceCount;
     uint32_t first;
     uint32_t number;
-    unsigned int pad1;
-    unsigned int pad2;
+    // Квадов каждого направления грани, по 16 бит (faceID 2k - младшие, 2k+1 - старшие).
+    // Квады в меше сгруппированы по направлениям (см. FaceCulling)
+    uint32_t faceQuads[3];
+    // 0 - квады по 2 uint32 (QuadFormat::Wide64). Иначе квады по 1 uint32 (Packed32),
+    // а сразу за ними (first + instanceCount) - столько слов палитры блоков чанка
+    uint32_t paletteWords;
+};
+
+// Движок мешинга (оба дают одинаковые квады)
+enum class MesherType {
+    Scalar, // MeshPlane: маска среза через ctx.get() на каждый воксель
+    Binary  // MeshPlaneBinary: битовые колонки, грани через AND NOT, слияние через countr_zero
+};
+
+// Как ячейка LOD (2^3, 4^3, 8^3 блоков) сводится к одному блоку
+enum class LodReduction {
+    Majority, // сплошная, если сплошных блоков не меньше половины; блок - самый частый
+    AnySolid  // сплошная, если есть хоть один сплошной блок (тонкие детали не пропадают)
+};
+
+// Формат квадов в пуле вершин
+enum class QuadFormat {
+    Wide64,  // 2 uint32 на квад: грань и ID блока внутри квада (PushGreedyQuad)
+    Packed32 // 1 uint32 на квад: грань - по диапазону направления, блок - индекс в палитре чанка (PackQuads32)
 };
 
 
@@ -33,6 +55,26 @@ inline float fov = 70.0f;
 inline int renderDistanceXZ = 8;   // радиус генерации по X и Z
 inline int renderHeightY   = 8;    // радиус генерации по Y (в блоках чанка, по высоте)
 inline int MAX_TERRAIN_HEIGHT  = 128;
+inline int worldSeed = 1773;       // сид шума рельефа (cubeBench задает его явно)
+inline MesherType mesherType = MesherType::Binary;
+inline QuadFormat quadFormat = QuadFormat::Packed32; // чанки с палитрой больше 128 типов остаются Wide64
+inline int lodStartDistance = 4;  // кольцо (в чанках), с которого начинается LOD 1; каждый следующий - вдвое дальше (0 - без LOD)
+inline int lodLevels = 3;         // сколько LOD за полным разрешением (до 3: 2x, 4x, 8x)
+inline int lodHysteresis = 1;     // на сколько колец ближе чанк возвращается на более детальный LOD
+inline LodReduction lodReduction = LodReduction::Majority;
+inline int lodGenerationMax = 2;  // дальние чанки до этого LOD генерируются прямо из сетки шума (0 - всегда полностью)
+inline bool columnGeneration = true; // генерировать стопку чанков (x, z) одной задачей и одной сеткой шума
+// Бюджеты главного потока на кадр, мкс (остаток переносится на следующий кадр)
+inline int newChunksBudgetUs = 1500;     // прием сгенерированных чанков
+inline int meshScheduleBudgetUs = 500;   // постановка чанков в мешинг
+inline int uploadBudgetUs = 2000;        // загрузка мешей на GPU
+inline bool useStagingRing = true;  // загрузка мешей через persistent-mapped кольцо (false - glNamedBufferSubData)
+inline int stagingSegmentMB = 8;    // размер сегмента кольца (сегментов - по числу кадров в полете)
+inline int jobWorkerCount = 0;      // воркеров JobSystem (0 - ядра минус главный поток и поисковик)
+inline bool pinJobWorkers = false;  // привязать воркеров к ядрам (только Linux)
+inline int vramCompactBudgetKB = 1024;       // перенос мешей при уплотнении пула вершин за кадр (0 - выкл)
+inline float vramCompactThreshold = 0.2f;    // уплотнять, когда раздробленность пула выше этой доли
+inline bool paletteStorage = false; // хранить сгенерированные чанки в палитре (плоский буфер - только для правок)
 
 inline bool programIsRunning = false;
 
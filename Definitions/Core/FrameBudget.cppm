@@ -0,0 +1,40 @@
+module;
+#include <chrono>
+#include <cstdint>
+
+export module FrameBudget;
+
+// Бюджет времени на стадию главного потока (новые чанки, постановка мешинга, загрузка).
+// Вместо фиксированного "256 штук за кадр" стадия берет элементы, пока по
+// измеренной цене (EMA) следующий еще помещается в бюджет. Остаток ждет следующего кадра.
+
+export struct StageBudget {
+    using Clock = std::chrono::steady_clock;
+
+    // Ожидаемая цена единицы веса в мкс (скользящее среднее)
+    double emaCostUs = 20.0;
+
+    // Счетчики последнего кадра (для заголовка окна / отладки)
+    uint32_t processedLastFrame = 0;
+    double spentLastFrameUs = 0.0;
+
+    // Начало стадии в этом кадре
+    void begin(int budgetUs);
+
+    // Влезет ли еще элемент веса weight. Первый элемент кадра берется всегда,
+    // иначе один дорогой элемент мог бы застрять навсегда.
+    [[nodiscard]] bool canTake(double weight = 1.0) const;
+
+    // Замер одного элемента: t0 - время начала (из now())
+    void record(Clock::time_point t0, double weight = 1.0);
+
+    // Конец стадии: переносит счетчики в *LastFrame
+    void end();
+
+    static Clock::time_point now() { return Clock::now(); }
+
+private:
+    Clock::time_point start{};
+    double budget = 0.0;
+    uint32_t processed = 0;
+};
@@ -0,0 +1,190 @@
+module;
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/vec3.hpp>
+
+export module JobSystem;
+
+// Единый планировщик фоновой работы: генерация, мешинг и ввод-вывод.
+// У каждого воркера свои очереди (по одной на класс приоритета) со своим мьютексом:
+// воркер берет из своей (самую срочную свою, а не глобально), а если пусто -
+// ворует у соседей, начиная со случайного. Внешние потоки (главный, поисковик)
+// раскладывают задачи по воркерам по кругу, общей очереди нет.
+
+// Внутри класса задачи лежат в корзинах по ключу приоритета (дистанция до игрока с
+// учетом направления взгляда). Ключ считается при постановке и помечается эпохой вида;
+// если к моменту извлечения игрок сдвинулся (эпоха другая), ключ пересчитывается:
+// задача переезжает в дальнюю корзину или отменяется. Полной перестройки нет.
+
+// Классы приоритета: меньше - важнее. Воркер сначала исчерпывает класс целиком
+// (свой и чужие), и только потом переходит к следующему.
+export enum class JobClass : uint8_t {
+    Meshing = 0,    // Видимый результат: меш уже сгенерированного чанка
+    Generation = 1, // Новые чанки
+    IO = 2          // Фоновая работа без срока (сохранение и т.п.)
+};
+
+export constexpr size_t JOB_CLASS_COUNT = 3;
+
+export using Job = std::function<void()>;
+
+// Корзины приоритета: ключ - дистанция в полу-чанках, корзина 0 - рядом с игроком
+export constexpr int PRIORITY_BUCKETS = 64;
+export constexpr float BUCKETS_PER_CHUNK = 2.0f;
+// Чанк прямо за спиной весит как в 1.5 раза более дальний
+export constexpr float BEHIND_PENALTY = 0.5f;
+
+// Точка зрения, от которой считаются ключи
+export struct JobView {
+    glm::ivec3 center{0};        // Чанк игрока
+    glm::vec3 forward{0, 0, -1}; // Направление взгляда (нормализованное)
+    // Радиус отмены по XZ в чанках для каждого класса (0 - не отменять).
+    // Квадрат: отменяется, если |dx| или |dz| больше радиуса.
+    float cancelRadius[JOB_CLASS_COUNT] = {0.0f, 0.0f, 0.0f};
+};
+
+// Результат пересчета ключа
+export constexpr int BUCKET_CANCELLED = -1;
+
+// Корзина для чанка при данном виде (или BUCKET_CANCELLED)
+export int priorityBucket(const JobView& view, JobClass cls, const glm::ivec3& chunk);
+
+// Счетчики ленивого пересчета
+export struct JobQueueStats {
+    uint64_t rekeyed = 0;   // Ключ пересчитан при извлечении (эпоха устарела)
+    uint64_t demoted = 0;   // Из них уехали в более дальнюю корзину
+    uint64_t cancelled = 0; // Из них отменены (вне радиуса)
+    uint32_t epoch = 0;
+};
+
+// Снимок счетчиков одного воркера с последнего resetStats()
+export struct WorkerStats {
+    uint64_t jobsRun = 0;
+    uint64_t jobsStolen = 0;  // Из них взято у других воркеров
+    uint64_t sleeps = 0;      // Сколько раз уходил в ожидание
+    double busyUs = 0.0;      // Время внутри задач
+    double wallUs = 0.0;      // Время с последнего сброса
+    double utilisation = 0.0; // busyUs / wallUs
+};
+
+export class JobSystem {
+private:
+    struct Entry {
+        Job run;
+        Job onCancel;          // Пусто - задачу нельзя отменить, только понизить
+        glm::ivec3 chunk{0};
+        uint32_t epoch = 0;    // Эпоха вида, при которой посчитана корзина
+        bool keyed = false;    // Без ключа - корзина 0, не пересчитывается
+    };
+
+    // FIFO без аллокаций в установившемся режиме (в отличие от deque не держит
+    // по блоку на каждую из PRIORITY_BUCKETS корзин)
+    struct Bucket {
+        std::vector<Entry> items;
+        size_t head = 0;
+    };
+
+    struct ClassQueue {
+        std::array<Bucket, PRIORITY_BUCKETS> buckets;
+    };
+
+    // Очереди одного воркера. Маски и счетчики очередей - на своей кэш-линии:
+    // их без блокировки читают соседи (есть ли что украсть, можно ли спать),
+    // не дергая линии мьютекса и корзин, в которые пишет владелец. Пишутся
+    // только под мьютексом воркера. Статистика - на отдельной линии.
+    struct Worker {
+        alignas(64) std::array<std::atomic<uint64_t>, JOB_CLASS_COUNT> masks{}; // Непустые корзины по классам
+        std::array<std::atomic<int64_t>, JOB_CLASS_COUNT> queued{};              // Задач в очередях по классам
+
+        alignas(64) std::mutex mutex;
+        std::array<ClassQueue, JOB_CLASS_COUNT> classes;
+
+        alignas(64) std::atomic<uint64_t> jobsRun{0};
+        std::atomic<uint64_t> jobsStolen{0};
+        std::atomic<uint64_t> sleeps{0};
+        std::atomic<uint64_t> busyNs{0};
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // В очередях + выполняются (только для waitIdle): +1 relaxed, -1 release после
+    // задачи, waitIdle читает acquire и видит все ее записи
+    std::atomic<int64_t> unfinished{0};
+
+    // Сон без задач
+    std::mutex sleepMutex;
+    std::condition_variable sleepCV;
+    std::atomic<int> sleepers{0};
+
+    std::atomic<uint32_t> nextWorker{0}; // Круговая раздача внешних задач
+    std::atomic<bool> stopping{false};
+    std::chrono::steady_clock::time_point statsEpoch;
+
+    // Вид: пишет главный поток, воркеры копируют при смене эпохи
+    mutable std::mutex viewMutex;
+    JobView view;
+    std::atomic<uint32_t> viewEpoch{1};
+
+    std::atomic<uint64_t> rekeyedCount{0};
+    std::atomic<uint64_t> demotedCount{0};
+    std::atomic<uint64_t> cancelledCount{0};
+
+    void workerLoop(uint32_t index, bool pin);
+    bool tryPop(uint32_t self, Job& out, bool& stolen);
+    bool popFrom(uint32_t worker, size_t cls, const JobView& v, uint32_t epoch, Job& out);
+    void push(uint32_t worker, JobClass cls, Entry&& entry);
+    static void pushLocked(Worker& w, size_t cls, int bucket, Entry&& entry);
+    static Entry popLocked(Worker& w, size_t cls, int bucket);
+    [[nodiscard]] bool hasQueued() const;
+    const JobView& currentView(uint32_t& epoch) const;
+    void wakeOne();
+
+public:
+    static JobSystem& Get();
+
+    // workerCount = 0 - по числу ядер минус главный поток и поисковик
+    void start(uint32_t workerCount = 0, bool pinToCores = false);
+
+    // Дорабатывает уже поставленные задачи и останавливает воркеров
+    void stop();
+
+    // Задача без ключа: корзина 0 своего класса, порядок - FIFO
+    void submit(JobClass cls, Job job);
+
+    // Задача с ключом - чанком. onCancel вызывается вместо run, если к моменту
+    // извлечения чанк вышел за радиус отмены класса (см. JobView::cancelRadius).
+    void submit(JobClass cls, const glm::ivec3& chunk, Job job, Job onCancel = {});
+
+    // Новый вид. Эпоха растет, только если сменился чанк игрока или взгляд
+    // повернулся заметно (иначе ключи не устаревают)
+    void setView(const glm::ivec3& center, const glm::vec3& forward);
+    void setCancelRadius(JobClass cls, float radiusChunks);
+
+    // Сколько задач класса ждет выполнения (не считая выполняемых)
+    [[nodiscard]] int64_t pending(JobClass cls) const;
+
+    // Ждет, пока все очереди опустеют и воркеры закончат текущие задачи.
+    // Только для бенчмарка/остановки: в кадре игры не вызывать.
+    void waitIdle();
+
+    [[nodiscard]] uint32_t workerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // Индекс воркера текущего потока или -1, если поток не воркер
+    [[nodiscard]] static int currentWorker();
+
+    std::vector<WorkerStats> stats() const;
+    [[nodiscard]] JobQueueStats queueStats() const;
+    void resetStats();
+
+    ~JobSystem();
+};
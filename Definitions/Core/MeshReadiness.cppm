@@ -0,0 +1,80 @@
+module;
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec3.hpp>
+
+import Chunk;
+import ChunkGrid;
+export module MeshReadiness;
+
+// Ворота мешинга при стриминге. Пока у чанка нет всех шести соседей по граням,
+// его меш почти наверняка придется выбросить: отсутствующий сосед считается
+// воздухом, и граничные грани строятся зря. Чанк ждет здесь, пока соседи не
+// придут (или пока сосед не окажется вне зоны загрузки - он уже не придет),
+// но не дольше timeout - для внешнего кольца и отмененной генерации.
+// Повторные пометки ждущего чанка сливаются в одну задачу мешинга.
+//
+// Только главный поток.
+
+// Зона, где соседей стоит ждать (включительно, в чанках)
+export struct LoadBox {
+    glm::ivec3 lo;
+    glm::ivec3 hi;
+
+    [[nodiscard]] bool contains(const glm::ivec3& p) const {
+        return p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y && p.z >= lo.z && p.z <= hi.z;
+    }
+};
+
+export struct MeshReadinessStats {
+    uint64_t marks = 0;    // Все пометки "нужен меш"
+    uint64_t merged = 0;   // Слились с уже ждущей/стоящей в очереди - меш сэкономлен
+    uint64_t deferred = 0; // Чанк не был готов сразу и ждал соседей
+    uint64_t released = 0; // Отдано в мешинг
+    uint64_t timedOut = 0; // Из них по таймауту, без полного набора соседей
+    uint64_t waiting = 0;  // Ждут сейчас
+};
+
+export class MeshReadiness {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Сколько ждать недостающих соседей
+    std::chrono::milliseconds timeout{250};
+
+    // Чанку нужен меш. alreadyQueued - он уже стоит в очереди мешинга
+    // (needsMeshUpdate), тогда пометка просто сливается.
+    void markDirty(const std::shared_ptr<Chunk>& chunk, bool alreadyQueued = false);
+
+    // Пришел чанк pos: его ждущие соседи проверяются заново
+    void neighbourArrived(const glm::ivec3& pos);
+
+    // Чанк выгружен - больше не ждем
+    void forget(const glm::ivec3& pos);
+
+    // Готовые к мешингу чанки -> out. Проверяются только затронутые с прошлого
+    // вызова и (раз в timeout/4) все ждущие на таймаут.
+    void collectReady(const ChunkMap& map, const ChunkGrid* grid, const LoadBox& box,
+                      Clock::time_point now, std::vector<std::shared_ptr<Chunk>>& out);
+
+    [[nodiscard]] MeshReadinessStats stats() const;
+
+private:
+    struct Waiting {
+        std::shared_ptr<Chunk> chunk;
+        Clock::time_point since;
+        bool deferred = false; // Уже посчитан в stats.deferred
+    };
+
+    std::unordered_map<glm::ivec3, Waiting, GoodVec3Hasher, FastIVec3Equal> waiting;
+    std::vector<glm::ivec3> recheck; // Позиции, которые надо проверить в ближайшем collectReady
+    Clock::time_point lastTimeoutScan{};
+
+    MeshReadinessStats counters;
+
+    [[nodiscard]] static bool neighboursReady(const glm::ivec3& pos, const ChunkMap& map,
+                                              const ChunkGrid* grid, const LoadBox& box);
+};
@@ -0,0 +1,53 @@
+module;
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <glm/vec3.hpp>
+
+import Chunk;
+import ChunkGrid;
+export module PaddedVolume;
+
+// Чанк вместе с однослойной "рамкой" из всех 26 соседей: 34x34x34 байт.
+// Любой проход, которому нужны соседние блоки (мешер, AO/освещение, физика),
+// читает из плоского массива без проверок границ и без обращений к карте.
+
+export constexpr int PADDED_SIZE = 34;
+export constexpr int PADDED_VOLUME = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+
+// Центр и 26 соседей. Индекс (dx+1) + (dy+1)*3 + (dz+1)*9, центр - 13.
+// Соседей из карты держат owners (их могут выгрузить в этот момент), соседей
+// из ChunkGrid - gridGuard: сетка не освободит их, пока жив этот объект.
+// Живет в одном потоке (локальная переменная вызывающего).
+export struct ChunkNeighborhood {
+    std::array<const Chunk*, 27> chunks{};
+    std::array<std::shared_ptr<Chunk>, 27> owners;
+    ChunkGrid::ReadGuard gridGuard;
+
+    static constexpr int index(int dx, int dy, int dz) { return (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9; }
+    [[nodiscard]] const Chunk* at(int dx, int dy, int dz) const { return chunks[index(dx, dy, dz)]; }
+};
+
+// Все 26 соседей. С сеткой - без блокировок (внутри ее окна); без сетки или вне
+// окна - одним пакетным запросом к карте (каждый шард блокируется один раз).
+// Центр не запрашивается: вызывающий уже держит его сам.
+export void fetchNeighborhood(const glm::ivec3& pos, const ChunkMap& map, ChunkNeighborhood& out,
+                              const ChunkGrid* grid = nullptr);
+
+export struct PaddedVolume {
+    // Отсутствующие соседи считаются воздухом
+    alignas(64) uint8_t data[PADDED_VOLUME];
+
+    // Индекс в массиве 34x34x34, x, y, z от 0 до 33
+    static constexpr int idx(int x, int y, int z) {
+        return x + y * PADDED_SIZE + z * PADDED_SIZE * PADDED_SIZE;
+    }
+
+    // Координаты чанка: 0..31 - сам чанк, -1 и 32 - соседи
+    [[nodiscard]] uint8_t get(int x, int y, int z) const {
+        return data[idx(x + 1, y + 1, z + 1)];
+    }
+
+    // Заполняет центр, 6 граней, 12 ребер и 8 углов
+    void build(const Chunk* center, const ChunkNeighborhood& nb);
+};
@@ -0,0 +1,63 @@
+module;
+#include <cstdint>
+
+export module TerrainKernels;
+
+// Горячие циклы генерации рельефа, вынесенные отдельно от потоков и очередей,
+// чтобы их можно было сравнивать и мерить в cubeBench.
+
+// Сетка шума низкого разрешения (шаг 2 блока). Порядок X -> Y -> Z.
+// Y на одну точку больше, чтобы покрыть 33-й слой (плотность "над" чанком).
+export constexpr int NOISE_LR_XZ = 17;
+export constexpr int NOISE_LR_Y  = 18;
+
+// Полное разрешение после апскейла. Порядок X -> Y -> Z.
+export constexpr int NOISE_HR_X = 32;
+export constexpr int NOISE_HR_Y = 33;
+export constexpr int NOISE_HR_Z = 32;
+
+export constexpr int NOISE_LR_SIZE = NOISE_LR_XZ * NOISE_LR_Y * NOISE_LR_XZ;
+export constexpr int NOISE_HR_SIZE = NOISE_HR_X * NOISE_HR_Y * NOISE_HR_Z;
+
+// Трилинейный апскейл 17x18x17 -> 32x33x32. Эталонная скалярная версия.
+export void upscaleNoiseScalar(const float* lowRes, float* highRes);
+
+// То же самое через xsimd: раздельные проходы Z -> Y -> X по целым строкам.
+// Результат побитово совпадает со скалярной версией (t всегда 0 или 0.5,
+// поэтому t*(b-a) точно и FMA ничего не меняет).
+// Без SIMD-архитектуры просто вызывает скалярную версию.
+export void upscaleNoise(const float* lowRes, float* highRes);
+
+// Плотность -> тип блока (воздух/трава/земля/камень) для одного чанка.
+// highRes - результат upscaleNoise, startY - мировая Y нижнего слоя чанка.
+// Каждая колонка X независима: сверху вниз несем плотность "над" и остаток земли.
+// dirtDepth (32x32, x + z*32) - остаток земли на входе сверху и на выходе снизу:
+// так стопка чанков раскрашивается как одна колонка (трава в самом низу чанка
+// получает землю в чанке под ним). nullptr - каждый чанк с нуля.
+// Эталонная скалярная версия.
+export void classifyBlocksScalar(const float* highRes, int startY, int seaLevel, uint8_t* blocks,
+                                 uint8_t* dirtDepth = nullptr);
+
+// То же самое через xsimd: 32 колонки X строки обрабатываются как SIMD-линии,
+// ветки заменены масками. На x86-64 набор инструкций (AVX2 или базовый SSE4.2)
+// выбирается при запуске по процессору, иначе берется из -march.
+// Результат совпадает со скалярной версией блок в блок.
+export void classifyBlocks(const float* highRes, int startY, int seaLevel, uint8_t* blocks,
+                           uint8_t* dirtDepth = nullptr);
+
+// Имя набора инструкций, который использует classifyBlocks (для бенчмарка).
+export const char* classifyBlocksArch();
+
+// Только остаток земли, который чанк отдает чанку ниже (как dirtDepth после
+// classifyBlocks), без апскейла и раскраски всего чанка: он зависит лишь от
+// нижних строк (толщина земли + 1). lowRes - сетка этого чанка (порядок X -> Y -> Z,
+// шаг по Y - NOISE_LR_XZ, по Z - strideZ), нужны только узлы Y = 0..2.
+export void dirtCarryFromAbove(const float* lowRes, int strideZ, int startY, int seaLevel, uint8_t* dirtDepth);
+
+// Прямая генерация прореженного чанка (дальние LOD, см. ChunkLod): плотность берется
+// в узлах сетки с шагом step блоков (2 или 4), апскейла и классификации 32^3 нет.
+// Сетка n x (n+1) x n, n = 32/step, порядок X -> Y -> Z, верхний слой - плотность
+// над чанком. Узел - нижний угол ячейки step^3 (та же точка, что у полной генерации),
+// ячейка заполняется одним блоком. blocks - полный буфер 32^3.
+export constexpr int coarseNoiseSize(int step) { return (32 / step) * (32 / step + 1) * (32 / step); }
+export void classifyBlocksCoarse(const float* coarse, int step, int startY, int seaLevel, uint8_t* blocks);
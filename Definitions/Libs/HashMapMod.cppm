@@ -8,6 +8,7 @@ module;
 #include <vector>
 #include <functional>
 #include <array>
+#include <algorithm>
 
 export module HashMapMod;
 
@@ -68,6 +69,31 @@ public:
         return Value{}; // Возвращаем дефолтное значение (nullptr)
     }
 
+    // 3b. Пакетное получение: каждый шард блокируется один раз на весь пакет
+    // (соседи чанка обычно раскиданы по разным шардам, но 26 блокировок подряд
+    // по одной на ключ заметно дороже). Нет элемента -> Value{}.
+    void tryGetMany(const Key* keys, Value* out, size_t count) const {
+        constexpr size_t BATCH = 32;
+        for (size_t base = 0; base < count; base += BATCH) {
+            const size_t n = std::min(BATCH, count - base);
+            size_t shardOf[BATCH];
+            bool done[BATCH] = {};
+            for (size_t i = 0; i < n; ++i) shardOf[i] = _hasher(keys[base + i]) % NumShards;
+
+            for (size_t i = 0; i < n; ++i) {
+                if (done[i]) continue;
+                const Shard& shard = _shards[shardOf[i]];
+                std::shared_lock<std::shared_mutex> lock(shard._mutex);
+                for (size_t j = i; j < n; ++j) {
+                    if (done[j] || shardOf[j] != shardOf[i]) continue;
+                    auto it = shard._map.find(keys[base + j]);
+                    out[base + j] = (it != shard._map.end()) ? it->second : Value{};
+                    done[j] = true;
+                }
+            }
+        }
+    }
+
     // 4. Проверка наличия
     bool contains(const Key& key) const {
         const Shard& shard = getShard(key);
@@ -0,0 +1,268 @@
+module;
+
+// --- Глобальный фрагмент (заголовки) ---
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module LockFreeQueue;
+
+// Ограниченные очереди без блокировок для передачи данных между потоками
+// (воркеры -> главный поток, поисковик -> главный поток).
+//
+// MpmcQueue - кольцо Вьюкова: у каждой ячейки свой счетчик-последовательность,
+// производители и потребители двигают свои позиции CAS'ом и никогда не ждут
+// друг друга, пока в кольце есть место. SpscQueue - для одного производителя
+// и одного потребителя, без CAS вообще.
+//
+// Емкость - степень двойки. Переполнение не теряет данные: push() крутится
+// (затем уступает квант) до появления места, и это время попадает в статистику.
+// Производители, которых при выключении никто не разгребает (воркеры, поисковик),
+// передают в push предикат остановки: ожидание обрывается, элемент выбрасывается.
+
+// Снимок счетчиков очереди
+export struct QueueStats {
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint64_t depth = 0;     // Сейчас в очереди (приблизительно)
+    uint64_t maxDepth = 0;  // Наибольшая глубина, увиденная при push
+    uint64_t fullWaits = 0; // Сколько push'ей застали очередь полной
+    double waitUs = 0.0;    // Суммарное ожидание места в push
+};
+
+// Счетчики общие для обеих очередей. Пишут производители, читает кто угодно.
+class QueueCounters {
+protected:
+    alignas(64) std::atomic<uint64_t> pushedCount{0};
+    std::atomic<uint64_t> maxDepthSeen{0};
+    std::atomic<uint64_t> fullWaitCount{0};
+    std::atomic<uint64_t> waitNs{0};
+    alignas(64) std::atomic<uint64_t> poppedCount{0};
+
+    void notePush(const uint64_t depth) {
+        pushedCount.fetch_add(1, std::memory_order_relaxed);
+        uint64_t seen = maxDepthSeen.load(std::memory_order_relaxed);
+        while (depth > seen && !maxDepthSeen.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    }
+
+    // Ждет, пока tryPush не пройдет или stop() не вернет true (тогда false).
+    // Первые попытки - активное ожидание (потребитель обычно разгребает очередь
+    // за микросекунды), дальше yield.
+    template <typename TryPush, typename Stop>
+    bool waitForSpace(TryPush&& tryPush, Stop&& stop) {
+        const auto t0 = std::chrono::steady_clock::now();
+        fullWaitCount.fetch_add(1, std::memory_order_relaxed);
+        bool pushed = true;
+        for (int spin = 0; !tryPush(); ++spin) {
+            if (stop()) {
+                pushed = false;
+                break;
+            }
+            if (spin >= 64) std::this_thread::yield();
+        }
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+        waitNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+        return pushed;
+    }
+
+    [[nodiscard]] QueueStats snapshot(const uint64_t depth) const {
+        QueueStats s;
+        s.pushed = pushedCount.load(std::memory_order_relaxed);
+        s.popped = poppedCount.load(std::memory_order_relaxed);
+        s.depth = depth;
+        s.maxDepth = maxDepthSeen.load(std::memory_order_relaxed);
+        s.fullWaits = fullWaitCount.load(std::memory_order_relaxed);
+        s.waitUs = static_cast<double>(waitNs.load(std::memory_order_relaxed)) * 1e-3;
+        return s;
+    }
+};
+
+// Ближайшая степень двойки >= n
+constexpr size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// --------------------------------------------------------
+// MpmcQueue (используется как MPSC: воркеры -> главный поток)
+// --------------------------------------------------------
+export template <typename T>
+class MpmcQueue : public QueueCounters {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+
+public:
+    explicit MpmcQueue(const size_t capacity) : mask(roundUpPow2(capacity < 2 ? 2 : capacity) - 1) {
+        cells = std::make_unique<Cell[]>(mask + 1);
+        for (size_t i = 0; i <= mask; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // false - очередь полна (value не тронут)
+    bool tryPush(T&& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        // Потребители могли уже уйти дальше pos + 1 (другие производители дописали
+        // следующие ячейки) - тогда разность отрицательная, глубина 0
+        const auto depth = static_cast<intptr_t>(pos + 1 - dequeuePos.load(std::memory_order_relaxed));
+        notePush(depth > 0 ? static_cast<uint64_t>(depth) : 0);
+        return true;
+    }
+
+    void push(T&& value) {
+        push(std::move(value), [] { return false; });
+    }
+
+    // Ждет места, пока stop() не вернет true. false - элемент не записан.
+    template <typename Stop>
+    bool push(T&& value, Stop&& stop) {
+        if (tryPush(std::move(value))) return true;
+        return waitForSpace([&] { return tryPush(std::move(value)); }, stop);
+    }
+
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->data = T{}; // Отпускаем ресурсы (shared_ptr, слэб меша) сразу, а не при перезаписи
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        poppedCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Забирает до maxItems элементов в конец out, возвращает сколько забрал
+    size_t popBatch(std::vector<T>& out, const size_t maxItems = SIZE_MAX) {
+        size_t taken = 0;
+        T item{};
+        while (taken < maxItems && tryPop(item)) {
+            out.push_back(std::move(item));
+            ++taken;
+        }
+        return taken;
+    }
+
+    [[nodiscard]] size_t capacity() const { return mask + 1; }
+
+    [[nodiscard]] size_t depth() const {
+        const size_t head = dequeuePos.load(std::memory_order_relaxed);
+        const size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] QueueStats stats() const { return snapshot(depth()); }
+};
+
+// --------------------------------------------------------
+// SpscQueue (один производитель, один потребитель)
+// --------------------------------------------------------
+export template <typename T>
+class SpscQueue : public QueueCounters {
+private:
+    std::unique_ptr<T[]> items;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> head{0}; // Пишет только потребитель
+    alignas(64) std::atomic<size_t> tail{0}; // Пишет только производитель
+
+public:
+    explicit SpscQueue(const size_t capacity) : mask(roundUpPow2(capacity < 2 ? 2 : capacity) - 1) {
+        items = std::make_unique<T[]>(mask + 1);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool tryPush(T&& value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t h = head.load(std::memory_order_acquire);
+        if (t - h > mask) return false;
+        items[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        notePush(t + 1 - h);
+        return true;
+    }
+
+    void push(T&& value) {
+        push(std::move(value), [] { return false; });
+    }
+
+    // Ждет места, пока stop() не вернет true. false - элемент не записан.
+    template <typename Stop>
+    bool push(T&& value, Stop&& stop) {
+        if (tryPush(std::move(value))) return true;
+        return waitForSpace([&] { return tryPush(std::move(value)); }, stop);
+    }
+
+    bool tryPop(T& out) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        out = std::move(items[h & mask]);
+        items[h & mask] = T{};
+        head.store(h + 1, std::memory_order_release);
+        poppedCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t popBatch(std::vector<T>& out, const size_t maxItems = SIZE_MAX) {
+        size_t taken = 0;
+        T item{};
+        while (taken < maxItems && tryPop(item)) {
+            out.push_back(std::move(item));
+            ++taken;
+        }
+        return taken;
+    }
+
+    [[nodiscard]] size_t capacity() const { return mask + 1; }
+
+    [[nodiscard]] size_t depth() const {
+        const size_t h = head.load(std::memory_order_relaxed);
+        const size_t t = tail.load(std::memory_order_relaxed);
+        return t > h ? t - h : 0;
+    }
+
+    [[nodiscard]] QueueStats stats() const { return snapshot(depth()); }
+};
@@ -10,6 +10,7 @@ import Camera;
 import Keyboard;
 import AABB;
 import Chunk;
+import ChunkGrid;
 
 export module Physic;
 
@@ -22,12 +23,13 @@ public:
     bool onGround = true;
     glm::vec3 kineticVector = glm::vec3(0.0f);
 
-    void makeTick(Keyboard &keyboard_control,std::vector<std::shared_ptr<Chunk>> &batchG, Camera &camera, double dt,ChunkMap &chunkMap, const Window &window);
+    void makeTick(Keyboard &keyboard_control,std::vector<std::shared_ptr<Chunk>> &batchG, Camera &camera, double dt,ChunkMap &chunkMap, const ChunkGrid &grid, const Window &window);
 
 
 
     // двигаем игрока с учётом коллизий
-    void movePlayer(AABB& playerAABB, glm::vec3& velocity,double dt, bool& onGround, ChunkMap &chunks);
+    // Блоки читаются через ChunkGrid (без блокировок), карта - только вне окна сетки
+    void movePlayer(AABB& playerAABB, glm::vec3& velocity,double dt, bool& onGround, ChunkMap &chunks, const ChunkGrid &grid);
 
 
     bool checkCollision(float aminx, float aminy, float aminz,float amaxx, float amaxy, float amaxz,float bminx, float bminy, float bminz,float bmaxx, float bmaxy, float bmaxz);
@@ -0,0 +1,38 @@
+module;
+#include <cstdint>
+#include <vector>
+
+#include "../Core/Config.h"
+
+import Chunk;
+import ChunkGrid;
+import MeshBufferPool;
+import FaceCulling;
+export module ChunkMesher;
+
+// Мешер не зависит от GL: его можно гонять без окна (cubeBench) и из любых потоков.
+
+// Строит greedy-меш чанка с учетом соседей из map прямо в out (out очищается,
+// емкость сохраняется). Формат: по 2 uint32 на квад (см. PushGreedyQuad).
+// Квады одного направления идут подряд (порядок - MESH_FACE_ORDER), их число
+// пишется в faceQuads. С grid соседи внутри окна сетки берутся без блокировок.
+// lod > 0 - объем сначала прореживается (ChunkLod), квады выходят кратными lodScale(lod).
+export void BuildChunkMeshInto(const Chunk* center, const ChunkMap& map, std::vector<uint32_t>& out, MesherType type,
+                               const ChunkGrid* grid = nullptr, FaceQuadCounts* faceQuads = nullptr, int lod = 0);
+
+// Основной путь игры: меш пишется в слэб из MeshBufferPool, хэндл уходит в очередь
+// загрузки без копий. Движок выбирается через mesherType, формат - через quadFormat (Config.h).
+export MeshHandle BuildChunkMeshPooled(const Chunk* center, const ChunkMap& map, const ChunkGrid* grid = nullptr,
+                                       int lod = 0);
+
+// Перепаковывает готовый меш (по 2 uint32 на квад) в 32-битный формат на месте:
+// [X:5][Y:5][Z:5][W-1:5][H-1:5][Palette:7], за квадами - палитра чанка (4 ID блока
+// на uint32, младший байт - индекс 0). Грань не хранится: ее дает диапазон направления.
+// Возвращает число слов палитры; 0 - типов больше 128, меш не тронут.
+export uint32_t PackQuads32(std::vector<uint32_t>& quads);
+
+// То же в новый вектор (копия из thread_local буфера)
+export std::vector<uint32_t> BuildChunkMesh(const Chunk* center, const ChunkMap& map);
+
+// То же с явным выбором движка (cubeBench сверяет их между собой).
+export std::vector<uint32_t> BuildChunkMesh(const Chunk* center, const ChunkMap& map, MesherType type);
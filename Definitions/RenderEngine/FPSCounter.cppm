@@ -1,4 +1,5 @@
 module;
+#include <functional>
 #include <iosfwd>
 #include <sstream>
 #include <GLFW/glfw3.h>
@@ -10,6 +11,7 @@ export struct FPSCounterAdvanced {
     double lastFrameTime = 0.0;
     int nbFrames = 0;
     double maxFrameTime = 0.0; // Самый долгий кадр за интервал
+    std::function<void(std::ostream&)> extraInfo; // Дописывает свое в заголовок (необязательно)
 
     void update(GLFWwindow* window) {
         double currentTime = glfwGetTime();
@@ -28,6 +30,7 @@ export struct FPSCounterAdvanced {
             ss << "FPS: " << int(fps)
                << " | Avg: " << avgMs << "ms"
                << " | Worst: " << worstMs << "ms"; // Если Worst сильно больше Avg -> у вас фризы!
+            if (extraInfo) extraInfo(ss);
 
             glfwSetWindowTitle(window, ss.str().c_str());
 
@@ -0,0 +1,38 @@
+module;
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+export module FaceCulling;
+
+// Отсечение граней целиком по направлению на уровне чанка. Мешер кладет квады
+// одного направления подряд, в ChunkMetadata лежит число квадов каждого
+// направления, и shader.comp выдает отдельную команду на каждое направление,
+// которое может смотреть на камеру. Здесь - CPU эталон того же решения
+// (cubeBench сверяет его с перебором плоскостей).
+//
+// Направления (faceID в квадре, см. PushGreedyQuad): 0:+Z 1:-Z 2:+Y 3:-Y 4:+X 5:-X.
+
+export constexpr int FACE_COUNT = 6;
+
+// Квадов каждого направления, индекс - faceID
+export using FaceQuadCounts = std::array<uint32_t, FACE_COUNT>;
+
+// Порядок направлений в меше: оси X, Y, Z, внутри оси сначала отрицательное.
+// Значит, квады направления f начинаются после всех направлений с большим faceID.
+export constexpr std::array<int, FACE_COUNT> MESH_FACE_ORDER = {5, 4, 3, 2, 1, 0};
+
+// Первый квад направления face внутри меша
+export uint32_t faceRangeStart(const FaceQuadCounts& counts, int face);
+
+// Упаковка в ChunkMetadata::faceQuads: по 16 бит на направление
+// (больше 16384 квадов одного направления в чанке 32^3 не бывает)
+export void packFaceQuads(const FaceQuadCounts& counts, uint32_t packed[3]);
+export FaceQuadCounts unpackFaceQuads(const uint32_t packed[3]);
+
+// Маска направлений (бит faceID), грани которых могут смотреть на камеру.
+// relMin - угол чанка минус позиция камеры, size - ребро чанка в блоках.
+// Грань +X в плоскости x = p видна, только если камера правее p, а плоскости
+// граней +X лежат в (min, max] - отсюда проверка по углу чанка (с запасом в блок,
+// чтобы не зависеть от округления). Для отрицательных - зеркально.
+export uint32_t visibleFaceMask(const glm::vec3& relMin, float size = 32.0f);
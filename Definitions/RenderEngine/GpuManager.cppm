@@ -7,51 +7,55 @@ module;
 import ChunkGenerationSystem;
 import Chunk;
 import VramAllocator;
+import VRamCompactor;
+import StagingRing;
+import RetirementQueue;
+import FaceCulling;
+import MeshBufferPool;
 export module GpuManager;
 // Размер буфера: 256 МБ (хватит на ~20-30k чанков)
 // Увеличивайте при необходимости
 constexpr uint32_t MAX_VERTEX_BUFFER_SIZE = 512 * 1024 * 1024 / 4;
 constexpr int BUFFER_FRAMES = 3;
+// Сколько кадров с освобождениями может ждать GPU (драйвер может держать больше BUFFER_FRAMES)
+constexpr int RETIRE_MAX_FRAMES = 8;
 
-struct ZombieIndex {
-     int index;
-    uint64_t frameOfDeath;
-};
-export  std::vector<ZombieIndex> zombies;
 export  uint64_t globalFrameCounter = 0;
-// Структура для хранения отложенного обновления
-struct PendingUpdate {
-    Chunk* chunk;           // Указатель на чанк (для проверки валидности)
-    uint32_t newOffset;     // VRAM адрес нового меша
-    uint32_t newSize;       // Размер нового меша
-    uint32_t oldOffset;     // Старый адрес (для удаления)
-    uint32_t oldSize;       // Старый размер
-    uint64_t targetFrame;   // Когда применять
-    int metaIndex;          // Индекс слота в SSBO
+// Меши в пуле вершин по форматам (QuadFormat)
+export struct MeshFormatStats {
+    uint64_t quads = 0;        // Квадов в пуле
+    uint64_t bytes = 0;        // Байт под ними (с палитрами и выравниванием)
+    uint64_t packedChunks = 0; // Чанков в Packed32
+    uint64_t wideChunks = 0;   // Чанков в Wide64 (по настройке или палитра больше 128 типов)
 };
 
-std::vector<PendingUpdate> pendingUpdates;
-
-// Настройка задержки. При 1000 FPS 3 кадра = 3 мс, этого хватит для PCIe передачи.
-const int UPDATE_DELAY_FRAMES = 3;
-
 
 export class GpuManager {
 public:
-
-    struct ZombieMemory {
-        uint32_t offset;
-        uint32_t size;
-        uint64_t frameOfDeath;
-    };
-    std::vector<ZombieMemory> memoryZombies; // Очередь на удаление памяти
-
     GpuManager(int maxDist, int maxHeight);
     ~GpuManager();
 
-    void uploadChunk(Chunk* chunk, const std::vector<uint32_t>& meshData);
+    // Квады, их формат и диапазоны направлений берутся из MeshBuffer
+    void uploadChunk(Chunk* chunk, const MeshBuffer& mesh);
     void freeChunk(Chunk* chunk);
-    void processPendingUpdates();
+
+    // Отправляет все записи кадра, накопленные в StagingRing (вершины + метаданные).
+    // Вызывается в конце UploadToGPU; recycleZombies подбирает то, что пришло позже.
+    void flushUploads();
+
+    // Уплотнение пула вершин: переносит меши с верха пула в дыры снизу, не больше
+    // budgetBytes за вызов. Работает, только когда пул раздроблен сильнее
+    // vramCompactThreshold или последняя аллокация не прошла. Вызывать до загрузок
+    // кадра (uploadChunk): переносятся только вершины, уже отправленные прошлыми
+    // flushUploads, а новые first уходят ближайшим flushUploads вместе с загрузками.
+    void compactVertices(size_t budgetBytes);
+
+    // nullptr, если кольцо выключено (useStagingRing) или не удалось замапить
+    [[nodiscard]] const StagingRingStats* getStagingStats() const { return staging ? &staging->getStats() : nullptr; }
+    [[nodiscard]] VRamStats getVRamStats() const { return allocator->stats(); }
+    [[nodiscard]] VRamCompactorStats getCompactorStats() const { return compactor.stats(); }
+    [[nodiscard]] RetirementStats getRetirementStats() const { return retirement.getStats(); }
+    [[nodiscard]] MeshFormatStats getMeshFormatStats() const { return meshFormat; }
 
     // Синхронизация памяти (если используете Coherent, барьер делает драйвер, но для надежности оставим)
     static void syncMemory();
@@ -66,8 +70,15 @@ public:
     GLuint vao = 0;
     GLuint vertexSSBO = 0;      // Вся геометрия (Static)
     GLuint chunkInfoBuffer = 0; // Метаданные (ChunkMetadata[])
+    GLuint activeIndexBuffer = 0; // Плотный список слотов с непустым мешем (uint[]) - по нему идет куллинг
+
+    // Сколько слотов в activeIndexBuffer (размер dispatch куллинга и max draw count)
+    [[nodiscard]] uint32_t activeChunkCount() const { return static_cast<uint32_t>(activeSlots.size()); }
 
     int maxChunksCapacity = 0;
+
+    // Конец кадра: дописывает кольцо и закрывает кадр освобождений fence'ом.
+    // Слоты и память возвращаются, когда GPU пройдет fence их кадра.
     void recycleZombies();
 
 
@@ -75,16 +86,43 @@ public:
 private:
     std::unique_ptr<VRamAllocator> allocator;
     std::vector<int> freeChunkMetadataIndicesList;
+    RetirementQueue retirement{RETIRE_MAX_FRAMES};
 
-    // Указатели на Persistent Mapped память
-    uint32_t* mappedVertices = nullptr;
-    ChunkMetadata* mappedChunksInfos = nullptr;
+    // --- Уплотнение ---
+    VRamCompactor compactor;
+    std::vector<ChunkMetadata*> slotInfo; // Слот метаданных -> CPU копия (для правки first при переносе)
+    std::vector<VRamMove> compactMoves;
+    bool compactUrgent = false;           // Аллокация не прошла - уплотняем с повышенным бюджетом
+
+    MeshFormatStats meshFormat;
+    void noteMesh(const ChunkMetadata& info, int sign); // Учет меша в meshFormat (+1 - пришел, -1 - ушел)
 
     int allocateChunkMetadataIndex();
     void freeChunkMetadataIndex(int index);
 
+    // --- Кольцо загрузки ---
+    std::unique_ptr<StagingRing> staging;
+    // Метаданные, ждущие flushUploads. Несколько записей в один слот за кадр
+    // схлопываются в последнюю; соседние слоты уходят одной копией.
+    std::vector<ChunkMetadata> pendingMeta;
+    std::vector<int> pendingMetaSlots;
+    std::vector<int> pendingMetaPos; // Слот -> индекс в pendingMeta (-1 - нет записи)
 
-};
+    void writeVertices(uint32_t offset, const std::vector<uint32_t>& meshData, uint32_t alignedSize);
+    void writeMetadata(int index, const ChunkMetadata& data);
 
-// Функция мешинга без изменений
-export std::vector<uint32_t> BuildChunkMesh(const Chunk* center, const ChunkMap& map);
\ No newline at end of file
+    // --- Список активных слотов ---
+    // CPU копия activeIndexBuffer. Удаление - перестановкой последнего на место
+    // удаленного, так что за кадр меняется пара uint на каждое событие.
+    std::vector<uint32_t> activeSlots;
+    std::vector<int> activePos;         // Слот -> позиция в activeSlots (-1 - не активен)
+    std::vector<uint32_t> dirtyActive;  // Позиции, измененные с прошлого flushUploads
+    std::vector<uint8_t> activeDirty;   // Позиция уже в dirtyActive
+
+    void activateSlot(int slot);
+    void deactivateSlot(int slot);
+    void markActiveDirty(uint32_t pos);
+    void flushActiveSlots();
+
+
+};
@@ -0,0 +1,75 @@
+module;
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+export module MeshBufferPool;
+
+// Пул буферов меша: воркер пишет квады прямо в слэб из пула, слэб едет через
+// очередь загрузки к главному потоку и после glNamedBufferSubData возвращается
+// в пул вместе со своей емкостью. В установившемся режиме ни одной аллокации.
+
+// Начальная емкость слэба в uint32 (16 КБ = 2048 квадов, хватает почти всем чанкам)
+constexpr size_t MESH_SLAB_RESERVE = 4096;
+// Слэбы, раздувшиеся больше этого (редкие "шумные" чанки), в пул не возвращаем
+constexpr size_t MESH_SLAB_MAX_RETAINED = 64 * 1024;
+
+export struct MeshBuffer {
+    std::vector<uint32_t> quads; // По 2 uint32 на квад (см. PushGreedyQuad) или по 1 + палитра (PackQuads32)
+    std::array<uint32_t, 6> faceQuads{}; // Квадов каждого направления (FaceQuadCounts), заполняет мешер
+    uint32_t paletteWords = 0; // 0 - формат Wide64, иначе слов палитры в конце quads
+
+    [[nodiscard]] uint32_t quadCount() const {
+        return static_cast<uint32_t>(paletteWords ? quads.size() - paletteWords : quads.size() / 2);
+    }
+};
+
+// Счетчики для проверки нулевых аллокаций (все монотонные, кроме live/pooled)
+export struct MeshPoolStats {
+    uint64_t acquired = 0;     // Сколько раз выдали слэб
+    uint64_t slabsCreated = 0; // Новые слэбы (heap) - пул был пуст
+    uint64_t slabGrowths = 0;  // Слэб не влез в свою емкость и переаллоцировался
+    uint64_t slabsTrimmed = 0; // Слишком большие слэбы, удаленные при возврате
+    uint64_t live = 0;         // Выдано и еще не возвращено
+    uint64_t pooled = 0;       // Лежит в пуле
+};
+
+export class MeshBufferPool;
+
+// Возвращает слэб в пул при уничтожении хэндла
+export struct MeshBufferReturn {
+    void operator()(MeshBuffer* buffer) const;
+};
+
+export using MeshHandle = std::unique_ptr<MeshBuffer, MeshBufferReturn>;
+
+export class MeshBufferPool {
+private:
+    std::vector<MeshBuffer*> freeList;
+    std::mutex mutex;
+
+    std::atomic<uint64_t> acquiredCount{0};
+    std::atomic<uint64_t> createdCount{0};
+    std::atomic<uint64_t> growthCount{0};
+    std::atomic<uint64_t> trimmedCount{0};
+    std::atomic<uint64_t> liveCount{0};
+
+public:
+    static MeshBufferPool& Get();
+
+    // Пустой слэб (size 0, емкость сохранена)
+    MeshHandle acquire();
+
+    void release(MeshBuffer* buffer);
+
+    // Вызывается мешером, если слэб пришлось расширить
+    void noteGrowth() { growthCount.fetch_add(1, std::memory_order_relaxed); }
+
+    MeshPoolStats stats();
+
+    ~MeshBufferPool();
+};
@@ -0,0 +1,84 @@
+module;
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+export module RetirementQueue;
+
+// Отложенное освобождение GPU ресурсов (слоты метаданных, диапазоны вершин).
+// Все, что освобождено за кадр, складывается в корзину кадра; в конце кадра
+// корзина закрывается glFenceSync. Корзина отдается обратно, когда GPU прошел
+// ее fence - сколько бы кадров ни держал в очереди драйвер. Корзины лежат в
+// кольце: освобождение - проход по готовым корзинам целиком, без erase из
+// середины вектора. Если кольцо заполнено, ждем самую старую корзину.
+//
+// Только главный поток (GL контекст).
+
+export struct RetirementStats {
+    uint64_t framesRetired = 0;  // Корзин отдано
+    uint64_t slotsReleased = 0;
+    uint64_t rangesReleased = 0;
+    uint64_t ringFullWaits = 0;  // Кольцо заполнено - ждали GPU
+    double ringFullWaitMs = 0.0;
+    size_t framesPending = 0;    // Закрытых корзин ждут fence
+};
+
+export class RetirementQueue {
+public:
+    // maxFrames - сколько закрытых кадров может ждать GPU одновременно
+    explicit RetirementQueue(int maxFrames);
+    ~RetirementQueue();
+
+    RetirementQueue(const RetirementQueue&) = delete;
+    RetirementQueue& operator=(const RetirementQueue&) = delete;
+
+    // GPU еще может читать слот / диапазон в командах этого кадра
+    void retireSlot(int slot) { buckets[current].slots.push_back(slot); }
+    void retireRange(uint32_t offset, uint32_t size) { buckets[current].ranges.push_back({offset, size}); }
+
+    // Конец кадра (после последней записи, которая прячет освобожденное):
+    // закрывает корзину fence'ом и отдает все корзины, чей fence уже пройден.
+    template <typename OnSlot, typename OnRange>
+    void endFrame(OnSlot&& onSlot, OnRange&& onRange) {
+        closeCurrent();
+        // Кольцо полное - следующая корзина еще занята, ее придется дождаться
+        while (closed > 0 && waitOldest(closed == static_cast<int>(buckets.size()))) {
+            Bucket& bucket = buckets[oldest];
+            for (const int slot : bucket.slots) onSlot(slot);
+            for (const Range& range : bucket.ranges) onRange(range.offset, range.size);
+            stats.slotsReleased += bucket.slots.size();
+            stats.rangesReleased += bucket.ranges.size();
+            stats.framesRetired++;
+            bucket.slots.clear();
+            bucket.ranges.clear();
+            oldest = (oldest + 1) % static_cast<int>(buckets.size());
+            --closed;
+        }
+    }
+
+    [[nodiscard]] RetirementStats getStats() const;
+
+private:
+    struct Range {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct Bucket {
+        GLsync fence = nullptr;
+        std::vector<int> slots;
+        std::vector<Range> ranges;
+    };
+
+    std::vector<Bucket> buckets;
+    int current = 0; // Сюда пишутся освобождения кадра
+    int oldest = 0;  // Самая старая закрытая корзина
+    int closed = 0;  // Закрытых корзин ждут fence
+
+    RetirementStats stats;
+
+    void closeCurrent();
+    // true - fence самой старой корзины пройден (wait - ждать, пока не пройдет); fence удаляется
+    bool waitOldest(bool wait);
+};
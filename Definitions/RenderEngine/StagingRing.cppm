@@ -0,0 +1,69 @@
+module;
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+export module StagingRing;
+
+// Кольцо загрузки поверх одного persistent-coherent буфера, разбитого на сегменты.
+// За кадр все записи копируются в текущий сегмент на CPU, а в flush() уходят
+// на GPU парой glCopyNamedBufferSubData (соседние копии склеиваются).
+// После flush сегмент закрывается glFenceSync и переиспользуется только тогда,
+// когда GPU дошел до этого fence (тройная буферизация: CPU не ждет GPU).
+
+export struct StagingRingStats {
+    uint64_t bytesStaged = 0;   // Сколько байт прошло через кольцо
+    uint64_t stageCalls = 0;    // Записей (вершины + метаданные)
+    uint64_t copyCalls = 0;     // glCopyNamedBufferSubData после склейки
+    uint64_t overflows = 0;     // Не хватило сегмента -> вызывающий пишет напрямую
+    uint64_t fenceWaits = 0;    // Сегмент оказался занят GPU
+    double fenceWaitMs = 0.0;   // Сколько ждали
+};
+
+export class StagingRing {
+public:
+    StagingRing(size_t segmentBytes, int segmentCount);
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    // Буфер создан и замаплен (иначе вызывающий использует glNamedBufferSubData)
+    [[nodiscard]] bool valid() const { return mapped != nullptr; }
+
+    // Копирует bytes в текущий сегмент и ставит копию в dst[dstOffset] на flush().
+    // false - сегмент переполнен, ничего не записано.
+    bool stage(GLuint dst, GLintptr dstOffset, const void* src, size_t bytes);
+
+    // Место под запись напрямую (dst/dstOffset как у stage). nullptr - переполнение.
+    void* reserve(GLuint dst, GLintptr dstOffset, size_t bytes);
+
+    // Отправляет накопленные копии, закрывает сегмент fence'ом и переходит к следующему.
+    // Пустой сегмент не переключается.
+    void flush();
+
+    [[nodiscard]] const StagingRingStats& getStats() const { return stats; }
+    [[nodiscard]] size_t getSegmentBytes() const { return segmentSize; }
+
+private:
+    struct PendingCopy {
+        GLuint dst;
+        GLintptr srcOffset;
+        GLintptr dstOffset;
+        GLsizeiptr size;
+    };
+
+    GLuint buffer = 0;
+    uint8_t* mapped = nullptr;
+    size_t segmentSize = 0;
+    int segments = 0;
+
+    int current = 0;             // Текущий сегмент
+    size_t cursor = 0;           // Заполнено байт в текущем сегменте
+    std::vector<GLsync> fences;  // По одному на сегмент (0 - свободен)
+    std::vector<PendingCopy> copies;
+
+    StagingRingStats stats;
+
+    void waitSegment(int segment);
+};
@@ -1,56 +1,110 @@
 module;
 #include <vector>
 #include <cstdint>
-#include <condition_variable>
-#include <functional>
-#include <queue>
-#include <thread>
+#include <unordered_map>
 export module VramAllocator;
 
+// Снимок занятости пула (все размеры - в единицах аллокатора, у GpuManager это uint32)
+export struct VRamStats {
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    uint32_t freeTotal = 0;
+    uint32_t largestFree = 0;        // Самый большой свободный блок
+    size_t freeBlocks = 0;
+    float externalFragmentation = 0; // 1 - largestFree / freeTotal (0 - вся свобода одним куском)
+};
+
+export constexpr uint32_t VRAM_ALLOC_FAILED = 0xFFFFFFFF;
+
+// ==========================================
+// 1. TLSF (two-level segregated fit)
+// ==========================================
+// Свободные блоки разложены по классам размера: первый уровень - степень двойки,
+// второй - 16 равных долей внутри нее. Непустые классы отмечены в битовых масках,
+// поэтому поиск подходящего блока - два countr_zero, а не проход по списку.
+// Соседи по адресу связаны (граничные теги на стороне CPU - в видеопамять
+// служебные данные не пишем), так что слияние при free - тоже O(1).
 export class VRamAllocator {
-    struct Block {
-        uint32_t offset;
-        uint32_t size;
+    static constexpr uint32_t SL_LOG2 = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+    static constexpr uint32_t FL_COUNT = 32 - SL_LOG2 + 1;
+    static constexpr uint32_t NIL = 0xFFFFFFFF;
+    // Остаток меньше этого не отрезаем (отдаем вместе с блоком) - против пыли
+    static constexpr uint32_t MIN_SPLIT = 4;
+
+    struct Node {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        uint32_t prevPhys = NIL; // Соседи по адресу
+        uint32_t nextPhys = NIL;
+        uint32_t prevFree = NIL; // Соседи в списке своего класса
+        uint32_t nextFree = NIL;
+        bool isFree = false;
     };
 
-    // Вектор вместо map. Это уберет _Rb_tree_increment из профайлера.
-    std::vector<Block> freeBlocks;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> spareNodes; // Индексы переиспользуемых узлов
+    std::unordered_map<uint32_t, uint32_t> usedByOffset; // offset занятого блока -> узел
+    std::unordered_map<uint32_t, uint32_t> freeByOffset; // offset свободного блока -> узел (для allocateAt)
+
+    uint32_t flBitmap = 0;
+    uint32_t slBitmap[FL_COUNT] = {};
+    uint32_t freeHeads[FL_COUNT][SL_COUNT];
+
     uint32_t totalCapacity;
     uint32_t usedMemory = 0;
+    size_t freeBlockCount = 0;
+
+    static void mapping(uint32_t size, uint32_t& fl, uint32_t& sl);
+    uint32_t newNode();
+    void insertFree(uint32_t index);
+    void removeFree(uint32_t index);
+    void absorbNext(uint32_t index); // Сливает index со следующим по адресу (тот свободен)
+    uint32_t takeBlock(uint32_t index, uint32_t size); // Занимает начало блока, хвост - в свободные
 
 public:
     explicit VRamAllocator(uint32_t size);
 
-    // Аллокация (Best Fit или First Fit)
+    // O(1): offset или VRAM_ALLOC_FAILED
     uint32_t allocate(uint32_t size);
 
+    // O(1): слияние с соседями по адресу
     void free(uint32_t offset, uint32_t size);
 
+    // Занимает ровно [offset, offset + size), если там начинается свободный блок
+    // достаточного размера (для уплотнения: дыры ищет VRamCompactor). Иначе false.
+    bool allocateAt(uint32_t offset, uint32_t size);
+
     // Дебаг инфо
     [[nodiscard]] float getUsage() const;
     [[nodiscard]] size_t getFreeBlockCount() const;
+    [[nodiscard]] VRamStats stats() const;
 };
 
 // ==========================================
-// 2. Priority Thread Pool
+// 2. First fit (прежний аллокатор, для сравнения в cubeBench)
 // ==========================================
-export struct Task {
-    int priority; // Меньше число = выше важность (дистанция)
-    std::function<void()> func;
-    bool operator<(const Task& other) const { return priority > other.priority; }
-};
+export class FirstFitVRamAllocator {
+    struct Block {
+        uint32_t offset;
+        uint32_t size;
+    };
 
-export class PriorityThreadPool {
-    std::vector<std::thread> workers;
-    std::priority_queue<Task> tasks;
-    std::mutex queueMutex;
-    std::condition_variable condition;
-    std::atomic<bool> stop{false};
+    // Вектор вместо map. Это уберет _Rb_tree_increment из профайлера.
+    std::vector<Block> freeBlocks;
+    uint32_t totalCapacity;
+    uint32_t usedMemory = 0;
 
 public:
-    PriorityThreadPool(size_t threads);
+    explicit FirstFitVRamAllocator(uint32_t size);
+
+    // Аллокация (First Fit, линейный проход)
+    uint32_t allocate(uint32_t size);
 
-    ~PriorityThreadPool();
+    void free(uint32_t offset, uint32_t size);
 
-    void enqueue(int priority, std::function<void()> f);
+    // Дебаг инфо
+    [[nodiscard]] float getUsage() const;
+    [[nodiscard]] size_t getFreeBlockCount() const;
+    [[nodiscard]] VRamStats stats() const;
 };
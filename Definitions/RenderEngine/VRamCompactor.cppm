@@ -0,0 +1,64 @@
+module;
+#include <cstdint>
+#include <map>
+#include <vector>
+
+import VramAllocator;
+export module VRamCompactor;
+
+// Фоновое уплотнение пула вершин. Меши живут долго, а чанки выгружаются
+// вразнобой - пул покрывается дырами, и крупный меш может не влезть при
+// свободных сотнях мегабайт. Компактор понемногу (бюджет байт на кадр)
+// переносит меши с верха пула в дыры снизу: верх освобождается одним куском.
+//
+// Здесь только учет: кто где лежит и какие переносы сделать. Сами копии
+// (glCopyNamedBufferSubData) и правку ChunkMetadata.first делает GpuManager,
+// старый диапазон уходит в RetirementQueue и освобождается, когда GPU пройдет кадр.
+//
+// Только главный поток.
+
+// Один перенос: [from, from + size) -> [to, to + size). Диапазоны не пересекаются,
+// новый уже занят в аллокаторе, старый остается занятым до освобождения вызывающим.
+export struct VRamMove {
+    uint32_t owner; // Слот метаданных чанка
+    uint32_t from;
+    uint32_t to;
+    uint32_t size;
+};
+
+export struct VRamCompactorStats {
+    uint64_t moves = 0;      // Перенесено мешей за все время
+    uint64_t movedUnits = 0; // Перенесено памяти (в единицах аллокатора)
+    uint64_t passes = 0;     // Полных проходов по пулу
+    uint64_t blockedGaps = 0; // Дыры, которые нельзя занять (там зомби, еще не освобождены)
+    size_t tracked = 0;      // Живых мешей сейчас
+};
+
+export class VRamCompactor {
+public:
+    // Сколько мешей с верха пула пробовать под одну дыру
+    static constexpr int CANDIDATES_PER_GAP = 32;
+
+    // Аллокация [offset, offset + size) принадлежит owner
+    void track(uint32_t offset, uint32_t size, uint32_t owner);
+    // Аллокация ушла (в зомби или освобождена)
+    void untrack(uint32_t offset);
+
+    // Переносы на этот кадр, не больше budget единиц памяти. Новые диапазоны
+    // занимаются в allocator (allocateAt), учет сразу переключается на них.
+    // Возвращает перенесенный объем.
+    uint32_t plan(VRamAllocator& allocator, uint32_t budget, std::vector<VRamMove>& out);
+
+    [[nodiscard]] VRamCompactorStats stats() const;
+
+private:
+    struct Live {
+        uint32_t size;
+        uint32_t owner;
+    };
+
+    std::map<uint32_t, Live> live; // offset -> меш, по возрастанию адреса
+    uint32_t cursor = 0;           // Откуда продолжать поиск дыр (проход растянут на кадры)
+
+    VRamCompactorStats counters;
+};
@@ -3,8 +3,12 @@ module;
 
 #include <cstdint>
 #include <cmath>          // std::floor
+#include <cstring>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 // GLM нужен здесь, чтобы видеть операторы векторов
 #include <glm/vec3.hpp>
@@ -21,23 +25,140 @@ module Chunk;
 // --- Реализация методов ---
 
 uint8_t Chunk::get(const int x, const int y, const int z) const {
-    if (blocks == nullptr) {
-        return 255; // Лучше вернуть явный код ошибки (или 0), -1 для uint8_t это 255
-    }
     // CHUNK_SIZE теперь будет виден благодаря #include "Configuration/Constants.hpp" выше
     if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_SIZE || z < 0 || z >= CHUNK_SIZE) {
-        return 255;
+        return 255; // Лучше вернуть явный код ошибки (или 0), -1 для uint8_t это 255
+    }
+    const int index = x + y*CHUNK_SIZE + z*CHUNK_SIZE*CHUNK_SIZE;
+    if (const uint8_t* flat = data()) return flat[index];
+    if (packed) return packed->get(index);
+    return uniformBlock;
+}
+
+void Chunk::copyRow(const int y, const int z, uint8_t* dst) const {
+    const int index = y*CHUNK_SIZE + z*CHUNK_SIZE*CHUNK_SIZE;
+    if (const uint8_t* flat = data()) std::memcpy(dst, flat + index, CHUNK_SIZE);
+    else if (packed) packed->decodeRow(index, dst);
+    else std::memset(dst, uniformBlock, CHUNK_SIZE);
+}
+
+void Chunk::set(const int x, const int y, const int z, const uint8_t block) {
+    if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_SIZE || z < 0 || z >= CHUNK_SIZE) return;
+    if (isUniform() && block == uniformBlock) return; // Ничего не меняется
+
+    expand()[x + y*CHUNK_SIZE + z*CHUNK_SIZE*CHUNK_SIZE] = block;
+}
+
+uint8_t* Chunk::expand() {
+    if (uint8_t* flat = data()) return flat;
+
+    uint8_t* buffer = ChunkAllocator::Get().Allocate();
+    if (packed) {
+        for (int row = 0; row < CHUNK_SIZE * CHUNK_SIZE; ++row) {
+            packed->decodeRow(row * CHUNK_SIZE, buffer + row * CHUNK_SIZE);
+        }
+    } else {
+        std::fill_n(buffer, CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z, uniformBlock);
+    }
+
+    // Мешер может читать чанк из другого потока: сначала данные, потом указатель
+    blocks.store(buffer, std::memory_order_release);
+    return buffer;
+}
+
+// compactIfUniform() и compress() зовутся только до публикации чанка (поток генерации),
+// поэтому хватает relaxed: других читателей у буфера еще нет.
+bool Chunk::compactIfUniform() {
+    uint8_t* flat = blocks.load(std::memory_order_relaxed);
+    if (!flat) return !packed;
+
+    // Сравниваем словами по 8 байт: 32 КБ проходятся за пару микросекунд
+    uint64_t pattern = 0x0101010101010101ull * flat[0];
+    const auto* words = reinterpret_cast<const uint64_t*>(flat);
+    constexpr int WORDS = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z / 8;
+    for (int i = 0; i < WORDS; ++i) {
+        if (words[i] != pattern) return false;
     }
-    return blocks[x + y*CHUNK_SIZE + z*CHUNK_SIZE*CHUNK_SIZE];
+
+    uniformBlock = flat[0];
+    blocks.store(nullptr, std::memory_order_relaxed);
+    ChunkAllocator::Get().Free(flat);
+    return true;
+}
+
+bool Chunk::compress() {
+    uint8_t* flat = blocks.load(std::memory_order_relaxed);
+    if (!flat) return packed != nullptr;
+
+    constexpr int VOLUME = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
+
+    // 1. Какие ID встречаются
+    bool seen[256] = {};
+    for (int i = 0; i < VOLUME; ++i) seen[flat[i]] = true;
+
+    auto storage = std::make_unique<PalettedBlocks>();
+    uint8_t lookup[256] = {};
+    for (int id = 0; id < 256; ++id) {
+        if (!seen[id]) continue;
+        lookup[id] = static_cast<uint8_t>(storage->palette.size());
+        storage->palette.push_back(static_cast<uint8_t>(id));
+    }
+
+    const size_t kinds = storage->palette.size();
+    if (kinds == 1) return compactIfUniform();
+    if (kinds > 16) return false;
+
+    // 2. Ширина индекса: 1/2/4 бита
+    storage->bits = kinds <= 2 ? 1 : (kinds <= 4 ? 2 : 4);
+    const int perWord = 64 / storage->bits;
+    storage->words.assign(VOLUME / perWord, 0);
+
+    // 3. Упаковка
+    for (int i = 0; i < VOLUME; ++i) {
+        storage->words[i / perWord] |= uint64_t(lookup[flat[i]]) << ((i % perWord) * storage->bits);
+    }
+
+    packed = std::move(storage);
+    blocks.store(nullptr, std::memory_order_relaxed);
+    ChunkAllocator::Get().Free(flat);
+    return true;
+}
+
+size_t Chunk::memoryBytes() const {
+    if (data()) return CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
+    if (packed) return packed->memoryBytes();
+    return 0;
+}
+
+uint8_t PalettedBlocks::get(const int index) const {
+    const int perWord = 64 / bits;
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    return palette[(words[index / perWord] >> ((index % perWord) * bits)) & mask];
+}
+
+void PalettedBlocks::decodeRow(const int index, uint8_t* dst) const {
+    const int perWord = 64 / bits;
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    for (int k = 0; k < CHUNK_SIZE; ++k) {
+        const int i = index + k;
+        dst[k] = palette[(words[i / perWord] >> ((i % perWord) * bits)) & mask];
+    }
+}
+
+size_t PalettedBlocks::memoryBytes() const {
+    return sizeof(PalettedBlocks) + palette.capacity() + words.capacity() * sizeof(uint64_t);
 }
 
 Chunk::Chunk(const glm::ivec3 pos) : worldPosition(pos) {
     // ChunkAllocator теперь виден
-    blocks = ChunkAllocator::Get().Allocate();
+    blocks.store(ChunkAllocator::Get().Allocate(), std::memory_order_relaxed);
+}
+
+Chunk::Chunk(const glm::ivec3 pos, const uint8_t block) : worldPosition(pos), uniformBlock(block) {
 }
 
 Chunk::~Chunk() {
-    if (blocks) ChunkAllocator::Get().Free(blocks);
+    if (uint8_t* flat = blocks.load(std::memory_order_relaxed)) ChunkAllocator::Get().Free(flat);
 }
 
 glm::ivec3 getChunkIndex(const glm::vec3 worldPos) {
@@ -5,18 +5,30 @@
 module;
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
 #include <FastNoise/FastNoise.h>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 #include <memory>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/common.hpp>
 
 #include "../../Definitions/Core/Config.h"
 #include "../../Definitions/Core/Constants.hpp"
 
 import ChunkAllocator;
 import Chunk;
+import ChunkGrid;
+import JobSystem;
+import LockFreeQueue;
+import TerrainKernels;
+import ChunkLod;
 
 module ChunkGenerationSystem;
 
@@ -36,356 +48,510 @@ FastNoise::SmartNode<FastNoise::FractalFBm> GetTerrainNoise() {
     return noise;
 }
 
-// Вспомогательная функция линейной интерполяции (LERP)
-inline float lerp(float a, float b, float t) {
-    return a + t * (b - a);
+void generateLowResNoise(const glm::ivec3& chunkPos, float* out) {
+    // X, Z: 17 точек * шаг 2 = 32 единицы (индексы 0..31) - Идеально для ширины чанка.
+    // Y:    18 точек * шаг 2 = 34 единицы (индексы 0..33) - Покрывает нужный нам 32-й слой.
+    GetTerrainNoise()->GenUniformGrid3D(
+        out,
+        chunkPos.x * (NOISE_LR_XZ - 1), // startX
+        chunkPos.y * (NOISE_LR_XZ - 1), // startY (тут множитель 16, как по X/Z, чтобы чанки стыковались)
+        chunkPos.z * (NOISE_LR_XZ - 1), // startZ
+        NOISE_LR_XZ, NOISE_LR_Y, NOISE_LR_XZ, // size: Y = 18
+        0.004f * 2.0f,            // freq
+        worldSeed
+    );
 }
 
-// ... (Функция GetTerrainNoise и lerp остаются теми же) ...
+void generateCoarseNoise(const glm::ivec3& chunkPos, const int step, float* out) {
+    // Узел i сетки - точка (start + i) * freq. Частота кратна частоте lowResNoise
+    // (умножение на степень двойки точное), поэтому узлы совпадают с ее узлами.
+    const int n = CHUNK_SIZE_X / step;
+    GetTerrainNoise()->GenUniformGrid3D(
+        out,
+        chunkPos.x * n, chunkPos.y * n, chunkPos.z * n,
+        n, n + 1, n,
+        0.004f * 2.0f * static_cast<float>(step / 2),
+        worldSeed
+    );
+}
 
-std::shared_ptr<Chunk> generateChunkData(const glm::ivec3& chunkPos) {
+std::shared_ptr<Chunk> generateChunkData(const glm::ivec3& chunkPos, const int lod) {
     if (chunkPos.y * CHUNK_SIZE_Y > MAX_TERRAIN_HEIGHT) {
-        auto emptyChunk = std::make_shared<Chunk>(chunkPos);
-        emptyChunk->blocks = ChunkAllocator::Get().Allocate();
-        std::fill_n(emptyChunk->blocks, CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z, BLOCK_AIR);
-        return emptyChunk;
+        // Над рельефом только воздух: буфер не нужен вовсе
+        return std::make_shared<Chunk>(chunkPos, BLOCK_AIR);
     }
 
-    auto newChunk = std::make_shared<Chunk>(chunkPos);
-    newChunk->blocks = ChunkAllocator::Get().Allocate();
-
-    // --- НАСТРОЙКИ РАЗМЕРОВ (ВАЖНОЕ ИЗМЕНЕНИЕ) ---
-    // X, Z: 17 точек * шаг 2 = 32 единицы (индексы 0..31) - Идеально для ширины чанка.
-    // Y:    18 точек * шаг 2 = 34 единицы (индексы 0..33) - Покрывает нужный нам 32-й слой.
-    const int LR_XZ = 17;
-    const int LR_Y  = 18; // Было 17, стало 18
-
-    // Размеры полного массива (High Res)
-    const int HR_X = 32;
-    const int HR_Y = 33; // Нам нужно минимум 33 уровня (0..32)
-    const int HR_Z = 32;
-
-    // --- ПАМЯТЬ ---
-    thread_local std::vector<float> lowResNoise(LR_XZ * LR_Y * LR_XZ);
-    if (lowResNoise.size() < LR_XZ * LR_Y * LR_XZ) lowResNoise.resize(LR_XZ * LR_Y * LR_XZ);
+    if (lod > 0) {
+        // Буфер выделяет конструктор
+        auto newChunk = std::make_shared<Chunk>(chunkPos);
+
+        // Дальний LOD: плотность в узлах сетки, без апскейла
+        const int genLod = std::min(lod, GENERATION_LOD_MAX);
+        const int step = lodScale(genLod);
+        alignas(64) thread_local float coarseNoise[coarseNoiseSize(2)];
+        generateCoarseNoise(chunkPos, step, coarseNoise);
+        classifyBlocksCoarse(coarseNoise, step, chunkPos.y * CHUNK_SIZE_Y, SEA_LEVEL, newChunk->data());
+        newChunk->genLod = static_cast<uint8_t>(genLod);
+
+        if (paletteStorage) newChunk->compress();
+        else newChunk->compactIfUniform();
+        return newChunk;
+    }
 
-    thread_local std::vector<float> highResNoise(HR_X * HR_Y * HR_Z);
-    if (highResNoise.size() < HR_X * HR_Y * HR_Z) highResNoise.resize(HR_X * HR_Y * HR_Z);
+    // Полная раскраска - стопкой из одного чанка: generateColumnData берет шум на
+    // три узла выше и считает по ним остаток земли чанка сверху (dirtCarryFromAbove),
+    // так что чанк совпадает с тем же чанком из любой стопки (повышение LOD, поиск
+    // без стопок). Внутри: шум, апскейл 17x18x17 -> 32x33x32 и раскраска
+    // (см. TerrainKernels), затем сжатие (однородный - без буфера, иначе палитра).
+    thread_local std::vector<std::shared_ptr<Chunk>> single;
+    generateColumnData(chunkPos, 1, 1, nullptr, single);
+    auto newChunk = std::move(single.front());
+    single.clear();
+    return newChunk;
+}
 
-    // --- ГЕНЕРАЦИЯ ШУМА ---
+void generateColumnData(const glm::ivec3& bottom, const int count, const uint64_t mask, const uint8_t* lods,
+                        std::vector<std::shared_ptr<Chunk>>& out) {
+    out.clear();
+    if (count <= 0 || count > 64 || mask == 0) return;
+    const int lo = std::countr_zero(mask);
+    const int hi = 63 - std::countl_zero(mask);
+
+    // Над рельефом только воздух, шум не нужен (terrainTop - последний чанк с рельефом)
+    const int terrainTop = MAX_TERRAIN_HEIGHT / CHUNK_SIZE_Y - bottom.y;
+    for (int i = hi; i > terrainTop && i >= lo; --i) {
+        if ((mask >> i) & 1) out.push_back(std::make_shared<Chunk>(bottom + glm::ivec3(0, i, 0), BLOCK_AIR));
+    }
+    // Раскраска начинается чанком выше самого верхнего нужного (даже за count):
+    // он отдает остаток земли, и результат не зависит от того, где кончается стопка
+    const int first = std::min(hi + 1, terrainTop);
+    if (first < lo) return;
+    // От самого верхнего (если он не нужен) - только остаток земли: три нижних узла
+    const bool carryOnlyTop = first > hi;
+
+    // --- ШУМ НА ВСЮ СТОПКУ ---
+    // Те же узлы, что у generateLowResNoise каждого чанка: чанк i - слои
+    // 16*(i - lo) .. 16*(i - lo) + 17, соседние чанки делят два слоя.
+    constexpr int LR_ROWS = NOISE_LR_Y - 2; // Слоев на чанк без перекрытия
+    const int sizeY = carryOnlyTop ? (first - lo) * LR_ROWS + 3 : (first - lo + 1) * LR_ROWS + 2;
+    thread_local std::vector<float> columnNoise;
+    columnNoise.resize(static_cast<size_t>(NOISE_LR_XZ) * sizeY * NOISE_LR_XZ);
     GetTerrainNoise()->GenUniformGrid3D(
-        lowResNoise.data(),
-        chunkPos.x * (LR_XZ - 1), // startX
-        chunkPos.y * (LR_XZ - 1), // startY (тут множитель 16, как по X/Z, чтобы чанки стыковались)
-        chunkPos.z * (LR_XZ - 1), // startZ
-        LR_XZ, LR_Y, LR_XZ,       // size: Y теперь 18
-        0.004f * 2.0f,            // freq
-        1773
+        columnNoise.data(),
+        bottom.x * (NOISE_LR_XZ - 1),
+        (bottom.y + lo) * (NOISE_LR_XZ - 1),
+        bottom.z * (NOISE_LR_XZ - 1),
+        NOISE_LR_XZ, sizeY, NOISE_LR_XZ,
+        0.004f * 2.0f,
+        worldSeed
     );
 
-    // --- UPSCALING (ИНТЕРПОЛЯЦИЯ) ---
-    // i, k идут до 16. j (по Y) идет до 17.
-    for (int k = 0; k < LR_XZ - 1; ++k) {     // Z
-        for (int j = 0; j < LR_Y - 1; ++j) {  // Y (теперь сделает 17 итераций)
-            for (int i = 0; i < LR_XZ - 1; ++i) { // X
-
-                // Индексы LowRes (X -> Y -> Z)
-                // Y размерность теперь LR_Y (18), а не 17!
-                int idx000 = (i)     + (j)     * LR_XZ + (k)     * (LR_XZ * LR_Y);
-                int idx100 = (i + 1) + (j)     * LR_XZ + (k)     * (LR_XZ * LR_Y);
-                int idx010 = (i)     + (j + 1) * LR_XZ + (k)     * (LR_XZ * LR_Y);
-                int idx110 = (i + 1) + (j + 1) * LR_XZ + (k)     * (LR_XZ * LR_Y);
-
-                int strideZ = LR_XZ * LR_Y; // Смещение на один шаг по Z в LowRes
-                int idx001 = idx000 + strideZ;
-                int idx101 = idx100 + strideZ;
-                int idx011 = idx010 + strideZ;
-                int idx111 = idx110 + strideZ;
-
-                float v000 = lowResNoise[idx000]; float v100 = lowResNoise[idx100];
-                float v010 = lowResNoise[idx010]; float v110 = lowResNoise[idx110];
-                float v001 = lowResNoise[idx001]; float v101 = lowResNoise[idx101];
-                float v011 = lowResNoise[idx011]; float v111 = lowResNoise[idx111];
-
-                int xBase = i * 2;
-                int yBase = j * 2;
-                int zBase = k * 2;
-
-                for (int zOff = 0; zOff < 2; zOff++) {
-                    int hZ = zBase + zOff;
-                    if (hZ >= HR_Z) continue;
-
-                    float tZ = zOff * 0.5f;
-                    float c00 = lerp(v000, v001, tZ);
-                    float c10 = lerp(v100, v101, tZ);
-                    float c01 = lerp(v010, v011, tZ);
-                    float c11 = lerp(v110, v111, tZ);
-
-                    for (int yOff = 0; yOff < 2; yOff++) {
-                        int hY = yBase + yOff;
-                        if (hY >= HR_Y) continue; // Защита (до 33)
-
-                        float tY = yOff * 0.5f;
-                        float c0 = lerp(c00, c01, tY);
-                        float c1 = lerp(c10, c11, tY);
-
-                        for (int xOff = 0; xOff < 2; xOff++) {
-                            // X интерполяция
-                            float val = lerp(c0, c1, xOff * 0.5f);
-
-                            // Запись (X -> Y -> Z)
-                            // Размерность по Y в HighRes = HR_Y = 33!
-                            // Индекс: x + y*32 + z*32*33
-                            int hIdx = (xBase + xOff) + hY * HR_X + hZ * HR_X * HR_Y;
-                            highResNoise[hIdx] = val;
-                        }
-                    }
-                }
+    alignas(64) thread_local float lowResNoise[NOISE_LR_SIZE];
+    alignas(64) thread_local float highResNoise[NOISE_HR_SIZE];
+    alignas(64) thread_local float coarseNoise[coarseNoiseSize(2)];
+    uint8_t dirtDepth[CHUNK_SIZE_X * CHUNK_SIZE_Z] = {};
+
+    // Чанк i нужен в полном разрешении (его раскраска несет остаток земли сама)
+    auto fullNeeded = [&](const int i) {
+        return i >= lo && i < 64 && ((mask >> i) & 1) && !(lods && lods[i] > 0);
+    };
+
+    for (int i = first; i >= lo; --i) {
+        const float* src = columnNoise.data() + static_cast<size_t>(i - lo) * LR_ROWS * NOISE_LR_XZ;
+        const glm::ivec3 chunkPos = bottom + glm::ivec3(0, i, 0);
+        const int startY = chunkPos.y * CHUNK_SIZE_Y;
+
+        if (!fullNeeded(i)) {
+            // Уже загружен, выше стопки или прореженный: полному чанку ниже нужен
+            // только остаток земли - он считается по нижним строкам, без раскраски
+            if (fullNeeded(i - 1)) {
+                dirtCarryFromAbove(src, NOISE_LR_XZ * sizeY, startY, SEA_LEVEL, dirtDepth);
             }
+            if (i >= 64 || ((mask >> i) & 1) == 0) continue;
         }
+
+        // Срез чанка i: по Z-плоскости подряд NOISE_LR_Y строк X
+        for (int z = 0; z < NOISE_LR_XZ; ++z) {
+            std::memcpy(lowResNoise + z * NOISE_LR_XZ * NOISE_LR_Y,
+                        src + static_cast<size_t>(z) * NOISE_LR_XZ * sizeY,
+                        sizeof(float) * NOISE_LR_XZ * NOISE_LR_Y);
+        }
+
+        auto newChunk = std::make_shared<Chunk>(chunkPos);
+        const int genLod = lods ? std::min<int>(lods[i], GENERATION_LOD_MAX) : 0;
+        if (genLod > 0) {
+            // Узлы сетки шага step - каждый (step/2)-й узел среза (см. generateCoarseNoise)
+            const int step = lodScale(genLod);
+            const int n = CHUNK_SIZE_X / step, g = step / 2;
+            float* dst = coarseNoise;
+            for (int z = 0; z < n; ++z)
+                for (int y = 0; y <= n; ++y)
+                    for (int x = 0; x < n; ++x)
+                        *dst++ = lowResNoise[x * g + y * g * NOISE_LR_XZ + z * g * NOISE_LR_XZ * NOISE_LR_Y];
+            classifyBlocksCoarse(coarseNoise, step, startY, SEA_LEVEL, newChunk->data());
+            newChunk->genLod = static_cast<uint8_t>(genLod);
+        } else {
+            upscaleNoise(lowResNoise, highResNoise);
+            classifyBlocks(highResNoise, startY, SEA_LEVEL, newChunk->data(), dirtDepth);
+        }
+
+        if (paletteStorage) newChunk->compress();
+        else newChunk->compactIfUniform();
+        out.push_back(std::move(newChunk));
     }
+}
 
-    // --- ГЕНЕРАЦИЯ БЛОКОВ ---
-    const float DENSITY_THRESHOLD = 0.0f;
-    const int DIRT_THICKNESS = 3;
-    const float GRADIENT_STEP = 1.0f / 64.0f;
-    const int CHUNK_Y = 32;
-    int startY = chunkPos.y * CHUNK_Y;
 
-    // Страйды для HighRes массива
-    const int NR_STRIDE_Y = 32;
-    const int NR_STRIDE_Z = 32 * 33;
+// Дальние кольца - сразу прореженными (не грубее lodGenerationMax)
+static int generationLod(const glm::ivec3& chunkPos, const glm::ivec3& playerPos) {
+    return std::min(selectLod(chunkRing(chunkPos, playerPos), 0), std::clamp(lodGenerationMax, 0, GENERATION_LOD_MAX));
+}
 
-    // Временные буферы
-    float rowDensitiesAbove[32];
-    uint8_t rowDirtDepth[32];
+// Выключение: ожидание места в очередях к главному потоку обрывается
+static bool stopRequested() {
+    return !running.load(std::memory_order_relaxed);
+}
 
-    for (int z = 0; z < 32; ++z) {
-        float* noiseZPtr = &highResNoise[z * NR_STRIDE_Z];
-        uint8_t* blockZPtr = newChunk->blocks + (z * 32 * 32);
+static glm::ivec3 playerChunk() {
+    std::lock_guard<std::mutex> lock(playerPosMutex);
+    return currentPlayerChunk;
+}
 
-        // 1. Инициализация по Y=32
-        // ТЕПЕРЬ ТУТ ГАРАНТИРОВАННО ВАЛИДНЫЕ ДАННЫЕ
-        {
-            float* noiseTopRow = noiseZPtr + (32 * NR_STRIDE_Y);
-            float worldYTop = (float)(startY + CHUNK_Y);
-            float gradientTop = (SEA_LEVEL - worldYTop) * GRADIENT_STEP;
+void generateChunkJob(const glm::ivec3& chunkPos, const bool full) {
+    // Актуальность проверяет JobSystem при извлечении (радиус отмены класса Generation)
+    if (!running) {
+        pendingGeneration.erase(chunkPos);
+        return;
+    }
 
-            for (int x = 0; x < 32; ++x) {
-                rowDensitiesAbove[x] = noiseTopRow[x] + gradientTop;
-                rowDirtDepth[x] = 0;
-            }
-        }
+    // 1. Тяжелая работа
+    std::shared_ptr<Chunk> newChunk = generateChunkData(chunkPos, full ? 0 : generationLod(chunkPos, playerChunk()));
 
-        // 2. Цикл вниз
-        for (int y = CHUNK_Y - 1; y >= 0; --y) {
-            float* noiseRowPtr = noiseZPtr + (y * NR_STRIDE_Y);
-            uint8_t* blockRowPtr = blockZPtr + (y * 32);
-            float worldY = (float)(startY + y);
-            float rowGradient = (SEA_LEVEL - worldY) * GRADIENT_STEP;
-
-            for (int x = 0; x < 32; ++x) {
-                float currentDensity = noiseRowPtr[x] + rowGradient;
-                float densityUp = rowDensitiesAbove[x];
-
-                uint8_t blockType;
-                if (currentDensity > DENSITY_THRESHOLD) {
-                    // Если сверху пусто -> это трава
-                    if (densityUp <= DENSITY_THRESHOLD) {
-                        blockType = BLOCK_GRASS;
-                        rowDirtDepth[x] = DIRT_THICKNESS;
-                    }
-                    // Если сверху блок и есть запас земли -> земля
-                    else if (rowDirtDepth[x] > 0) {
-                        blockType = BLOCK_DIRT;
-                        rowDirtDepth[x]--;
-                    }
-                    // Иначе камень
-                    else {
-                        blockType = BLOCK_STONE;
-                    }
-                } else {
-                    blockType = BLOCK_AIR;
-                    rowDirtDepth[x] = 0;
-                }
+    // 2. Удаляем из "ожидающих"
+    pendingGeneration.erase(chunkPos);
 
-                blockRowPtr[x] = blockType;
-                rowDensitiesAbove[x] = currentDensity;
-            }
+    // 3. Отправляем результат (при выключении главный поток очередь уже не разгребает)
+    voxelDataQueue.push(std::move(newChunk), stopRequested);
+}
+
+void generateColumnJob(const glm::ivec3& bottom, const int count, const uint64_t mask) {
+    auto release = [&] {
+        for (int i = 0; i < count; ++i) {
+            if ((mask >> i) & 1) pendingGeneration.erase(bottom + glm::ivec3(0, i, 0));
         }
+    };
+    if (!running) {
+        release();
+        return;
     }
 
-    return newChunk;
-}
+    const glm::ivec3 playerPos = playerChunk();
+    uint8_t lods[64];
+    for (int i = 0; i < count; ++i) lods[i] = static_cast<uint8_t>(generationLod(bottom + glm::ivec3(0, i, 0), playerPos));
 
+    thread_local std::vector<std::shared_ptr<Chunk>> chunks;
+    generateColumnData(bottom, count, mask, lods, chunks);
 
-void chunkWorker() {
-    while (running) {
-        ChunkGenerationTask task{};
+    release();
+    for (auto& chunk : chunks) {
+        if (!voxelDataQueue.push(std::move(chunk), stopRequested)) break;
+    }
+    chunks.clear();
+}
 
-        // 1. Быстро берем задачу и освобождаем лок очереди
-        {
-            // unique_lock работает со SpinLock
-            std::unique_lock<std::mutex> lock(generationMutex);
+bool requestFullGeneration(const glm::ivec3& chunkPos) {
+    {
+        std::lock_guard<std::mutex> lock(generationMutex);
+        if (pendingGeneration.count(chunkPos) != 0) return false;
+        pendingGeneration.insert(chunkPos);
+    }
+    JobSystem::Get().submit(JobClass::Generation, chunkPos,
+                            [chunkPos] { generateChunkJob(chunkPos, true); },
+                            [chunkPos] { pendingGeneration.erase(chunkPos); });
+    return true;
+}
 
-            // Ждем с помощью condition_variable_any
-            generationCV.wait(lock, [] { return !generationQueue.empty() || !running; });
+// ==========================================
+// 5. Chunk Finder (инкрементальный)
+// ==========================================
+// Поисковик держит свое множество "запрошенных" позиций и при переходе игрока
+// в соседний чанк смотрит только слои, которые вошли в зону загрузки и вышли
+// из зоны хранения. Полный снимок карты больше не нужен: раз в несколько
+// секунд идет медленная сверка по ключам (без копирования shared_ptr).
 
-            if (!running && generationQueue.empty()) break;
+// Зона хранения больше зоны загрузки (гистерезис против дрожания на границе)
+constexpr int FINDER_KEEP_MARGIN = 2;
+constexpr int FINDER_BATCH_LIMIT = 100;
+constexpr size_t FINDER_QUEUE_LIMIT = 400;
+constexpr int UNLOAD_BUCKETS = 8;
+constexpr size_t UNLOAD_PER_TICK = 256;
+constexpr auto FINDER_SWEEP_PERIOD = std::chrono::seconds(3);
 
-            task = generationQueue.top();
-            generationQueue.pop();
-        }
+using PosSet = std::unordered_set<glm::ivec3, GoodVec3Hasher, FastIVec3Equal>;
 
-        // 2. Проверка актуальности
-        glm::ivec3 currentPlPos;
-        {
-            std::lock_guard<std::mutex> lock(playerPosMutex);
-            currentPlPos = currentPlayerChunk;
-        }
+using FinderBox = ChunkBox; // boxDifference - из ChunkGrid
 
-        auto dx = static_cast<float>(task.chunkPos.x - currentPlPos.x);
-        auto dz = static_cast<float>(task.chunkPos.z - currentPlPos.z);
-        float distSq = dx*dx + dz*dz;
-        float cancelRadius = static_cast<float>(renderDistanceXZ + 2);
+static FinderBox makeBox(const glm::ivec3& center, const int rxz, const int ry) {
+    return {center - glm::ivec3(rxz, ry, rxz), center + glm::ivec3(rxz, ry, rxz)};
+}
 
-        if (distSq > cancelRadius * cancelRadius) {
-            pendingGeneration.erase(task.chunkPos);
-            continue;
-        }
+static bool inBox(const FinderBox& box, const glm::ivec3& p) {
+    return p.x >= box.lo.x && p.x <= box.hi.x &&
+           p.y >= box.lo.y && p.y <= box.hi.y &&
+           p.z >= box.lo.z && p.z <= box.hi.z;
+}
 
-        // 3. Тяжелая работа
-        std::shared_ptr<Chunk> newChunk = generateChunkData(task.chunkPos);
+// Отмененные JobSystem задачи генерации (onCancel воркера -> поисковик). Позиция
+// уже снята с toLoad: если она снова в зоне загрузки, поисковик ставит ее заново.
+static std::mutex cancelledMutex;
+static std::vector<glm::ivec3> cancelledGeneration;
 
-        // 4. Удаляем из "ожидающих"
-        pendingGeneration.erase(task.chunkPos);
+static void onGenerationCancelled(const glm::ivec3& pos) {
+    pendingGeneration.erase(pos);
+    std::lock_guard<std::mutex> lock(cancelledMutex);
+    cancelledGeneration.push_back(pos);
+}
 
-        // 5. Отправляем результат
-        {
-            std::lock_guard<std::mutex> lock(voxelDataMutex);
-            voxelDataQueue.push(newChunk);
+struct ChunkFinderState {
+    PosSet owned;                    // Запрошены (или загружены) и еще не выгружены
+    std::vector<glm::ivec3> toLoad;  // Кандидаты на загрузку, ближайший - в конце
+    std::array<std::vector<glm::ivec3>, UNLOAD_BUCKETS> unloadBuckets; // По удалению за зону хранения
+    std::vector<glm::ivec3> scratch;
+    glm::ivec3 playerPos{999999};
+    std::chrono::steady_clock::time_point lastSweep{};
+};
+
+// Стопка (x, z) зоны загрузки одной задачей: все ее позиции, которых еще нет
+// ни в карте, ни в очереди. Ключ - чанк стопки на высоте игрока.
+// Возвращает, сколько чанков поставлено.
+static int submitColumnJob(ChunkFinderState& st, const glm::ivec3& target, const ChunkMap& chunks, const ChunkGrid& grid) {
+    const glm::ivec3 bottom(target.x, st.playerPos.y - renderHeightY, target.z);
+    const int count = renderHeightY * 2 + 1; // <= 64, см. chunkFinder
+
+    uint64_t mask = 0;
+    for (int i = 0; i < count; ++i) {
+        const glm::ivec3 pos = bottom + glm::ivec3(0, i, 0);
+        if (pendingGeneration.contains(pos)) continue;
+        if (grid.contains(pos, chunks)) st.owned.insert(pos);
+        else mask |= uint64_t{1} << i;
+    }
+    {
+        std::lock_guard<std::mutex> lock(generationMutex);
+        for (int i = 0; i < count; ++i) {
+            if (((mask >> i) & 1) == 0) continue;
+            const glm::ivec3 pos = bottom + glm::ivec3(0, i, 0);
+            if (pendingGeneration.count(pos) != 0) mask &= ~(uint64_t{1} << i);
+            else pendingGeneration.insert(pos);
         }
     }
+    if (mask == 0) return 0;
+
+    for (int i = 0; i < count; ++i) {
+        if ((mask >> i) & 1) st.owned.insert(bottom + glm::ivec3(0, i, 0));
+    }
+    const glm::ivec3 key(target.x, st.playerPos.y, target.z);
+    JobSystem::Get().submit(JobClass::Generation, key,
+                            [bottom, count, mask] { generateColumnJob(bottom, count, mask); },
+                            [bottom, count, mask] {
+                                for (int i = 0; i < count; ++i) {
+                                    if ((mask >> i) & 1) onGenerationCancelled(bottom + glm::ivec3(0, i, 0));
+                                }
+                            });
+    return std::popcount(mask);
 }
 
-std::vector<glm::ivec3> precomputedSpiralOffsets;
+static void sortToLoad(ChunkFinderState& st) {
+    const glm::ivec3 p = st.playerPos;
+    std::sort(st.toLoad.begin(), st.toLoad.end(), [p](const glm::ivec3& a, const glm::ivec3& b) {
+        const glm::ivec3 da = a - p, db = b - p;
+        const int distA = da.x*da.x + da.z*da.z, distB = db.x*db.x + db.z*db.z;
+        if (distA != distB) return distA > distB;
+        return std::abs(da.y) > std::abs(db.y);
+    });
+}
 
-void InitSpiralOffsets(int radius, int height) {
-    precomputedSpiralOffsets.clear();
-    precomputedSpiralOffsets.reserve((radius * 2 + 1) * (radius * 2 + 1) * (height * 2 + 1));
+// Отмененные позиции внутри зоны загрузки - обратно в кандидаты
+static void requeueCancelled(ChunkFinderState& st) {
+    st.scratch.clear();
+    {
+        std::lock_guard<std::mutex> lock(cancelledMutex);
+        st.scratch.swap(cancelledGeneration);
+    }
+    if (st.scratch.empty()) return;
+
+    const FinderBox load = makeBox(st.playerPos, renderDistanceXZ, renderHeightY);
+    bool added = false;
+    for (const auto& pos : st.scratch) {
+        st.owned.erase(pos);
+        if (!inBox(load, pos)) continue;
+        st.toLoad.push_back(pos);
+        finderStats.requeued++;
+        added = true;
+    }
+    if (added) sortToLoad(st);
+}
 
-    for (int x = -radius; x <= radius; ++x) {
-        for (int z = -radius; z <= radius; ++z) {
-            for (int y = -height; y <= height; ++y) {
-                precomputedSpiralOffsets.push_back(glm::ivec3(x, y, z));
-            }
+static void addUnloadCandidate(ChunkFinderState& st, const glm::ivec3& pos) {
+    const glm::ivec3 d = glm::abs(pos - st.playerPos);
+    const int excess = std::max(std::max(d.x, d.z) - (renderDistanceXZ + FINDER_KEEP_MARGIN),
+                                d.y - (renderHeightY + FINDER_KEEP_MARGIN));
+    const int bucket = std::clamp(excess - 1, 0, UNLOAD_BUCKETS - 1);
+    st.unloadBuckets[bucket].push_back(pos);
+}
+
+// Переход игрока в другой чанк: только вошедшие и вышедшие слои
+static void onPlayerMoved(ChunkFinderState& st, const glm::ivec3& newPos) {
+    const glm::ivec3 oldPos = st.playerPos;
+    st.playerPos = newPos;
+    finderStats.boundaryCrossings++;
+
+    const FinderBox newLoad = makeBox(newPos, renderDistanceXZ, renderHeightY);
+    const glm::ivec3 jump = glm::abs(newPos - oldPos);
+    const bool teleport = std::max(jump.x, std::max(jump.y, jump.z)) > renderDistanceXZ;
+
+    // 1. Вход в зону загрузки
+    st.scratch.clear();
+    if (teleport) {
+        st.toLoad.clear();
+        for (const auto& offset : precomputedSpiralOffsets) st.scratch.push_back(newPos + offset);
+    } else {
+        boxDifference(makeBox(oldPos, renderDistanceXZ, renderHeightY), newLoad, st.scratch);
+        // Старые кандидаты, оставшиеся за зоной загрузки, больше не нужны
+        std::erase_if(st.toLoad, [&newLoad](const glm::ivec3& p) { return !inBox(newLoad, p); });
+    }
+    finderStats.slabPositions += st.scratch.size();
+    st.toLoad.insert(st.toLoad.end(), st.scratch.begin(), st.scratch.end());
+    sortToLoad(st);
+
+    // 2. Выход из зоны хранения
+    const FinderBox newKeep = makeBox(newPos, renderDistanceXZ + FINDER_KEEP_MARGIN, renderHeightY + FINDER_KEEP_MARGIN);
+    if (teleport) {
+        for (const auto& pos : st.owned) {
+            if (!inBox(newKeep, pos)) addUnloadCandidate(st, pos);
+        }
+    } else {
+        st.scratch.clear();
+        boxDifference(newKeep, makeBox(oldPos, renderDistanceXZ + FINDER_KEEP_MARGIN, renderHeightY + FINDER_KEEP_MARGIN), st.scratch);
+        finderStats.slabPositions += st.scratch.size();
+        for (const auto& pos : st.scratch) {
+            if (st.owned.contains(pos)) addUnloadCandidate(st, pos);
         }
     }
-
-    std::sort(precomputedSpiralOffsets.begin(), precomputedSpiralOffsets.end(),
-        [](const glm::ivec3& a, const glm::ivec3& b) {
-            int distA = a.x*a.x + a.z*a.z;
-            int distB = b.x*b.x + b.z*b.z;
-            if (distA != distB) return distA < distB;
-            return std::abs(a.y) < std::abs(b.y);
-        });
 }
 
+// Медленная сверка с картой: подхватывает чанки, о которых поисковик не знает
+// (отмененные и все-таки догенерированные), и забывает отмененные задачи.
+static void sweepOwned(ChunkFinderState& st, const ChunkMap& chunks) {
+    finderStats.fullSweeps++;
+    const FinderBox keep = makeBox(st.playerPos, renderDistanceXZ + FINDER_KEEP_MARGIN, renderHeightY + FINDER_KEEP_MARGIN);
 
-// ==========================================
-// 5. Chunk Finder (На SpinLock)
-// ==========================================
+    for (const auto& pos : chunks.getKeys()) {
+        if (!inBox(keep, pos)) addUnloadCandidate(st, pos);
+        else st.owned.insert(pos);
+    }
+    std::erase_if(st.owned, [&](const glm::ivec3& pos) {
+        return !inBox(keep, pos) || (!chunks.contains(pos) && !pendingGeneration.contains(pos));
+    });
+}
 
-void chunkFinder(const ChunkMap& chunks) {
+void chunkFinder(const ChunkMap& chunks, const ChunkGrid& grid) {
     if (precomputedSpiralOffsets.empty()) {
         InitSpiralOffsets(renderDistanceXZ, renderHeightY);
     }
 
-    size_t spiralIndex = 0;
-    glm::ivec3 lastPlayerPos = glm::ivec3(999999);
+    ChunkFinderState st;
+    st.owned.reserve(precomputedSpiralOffsets.size() * 2);
 
     while (running) {
+        const auto tickStart = std::chrono::steady_clock::now();
+        finderStats.ticks++;
+
         glm::ivec3 playerPos;
         {
             std::lock_guard<std::mutex> lock(playerPosMutex);
             playerPos = currentPlayerChunk;
         }
 
-        if (playerPos != lastPlayerPos) {
-            spiralIndex = 0;
-            lastPlayerPos = playerPos;
-        }
-
-        size_t queueSize;
-        {
-            std::lock_guard<std::mutex> lock(generationMutex);
-            queueSize = generationQueue.size();
-        }
+        if (playerPos != st.playerPos) onPlayerMoved(st, playerPos);
+        requeueCancelled(st);
 
-        if (queueSize > 400) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            continue;
-        }
+        const auto queueSize = static_cast<size_t>(std::max<int64_t>(0, JobSystem::Get().pending(JobClass::Generation)));
 
-        // --- БЫСТРЫЙ ПОИСК ---
+        // --- ЗАГРУЗКА: ближайшие кандидаты ---
+        // Стопка целиком помещается в маску generateColumnJob
+        const bool useColumns = columnGeneration && renderHeightY * 2 + 1 <= 64;
         int tasksAdded = 0;
-        const int BATCH_LIMIT = 100;
-
-        for (; spiralIndex < precomputedSpiralOffsets.size(); ++spiralIndex) {
-            if (tasksAdded >= BATCH_LIMIT) break;
-
-            glm::ivec3 offset = precomputedSpiralOffsets[spiralIndex];
-            glm::ivec3 targetPos = playerPos + offset;
+        while (queueSize + tasksAdded < FINDER_QUEUE_LIMIT && tasksAdded < FINDER_BATCH_LIMIT && !st.toLoad.empty()) {
+            const glm::ivec3 targetPos = st.toLoad.back();
+            st.toLoad.pop_back();
 
             if (pendingGeneration.contains(targetPos)) continue;
-            if (chunks.contains(targetPos)) continue;
+            if (grid.contains(targetPos, chunks)) {
+                st.owned.insert(targetPos);
+                continue;
+            }
 
-            {
-                std::lock_guard<std::mutex> lock(generationMutex);
-                if (pendingGeneration.count(targetPos) == 0) {
-                    pendingGeneration.insert(targetPos);
-                    float distSq = (float)(offset.x*offset.x + offset.z*offset.z);
-                    generationQueue.push({ targetPos, distSq });
+            if (useColumns) {
+                const int added = submitColumnJob(st, targetPos, chunks, grid);
+                if (added > 0) {
+                    finderStats.loadRequests += added;
                     tasksAdded++;
                 }
+                continue;
             }
-        }
 
-        if (spiralIndex >= precomputedSpiralOffsets.size()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        } else if (tasksAdded > 0) {
-            generationCV.notify_all();
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
-        } else {
-             std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            {
+                std::lock_guard<std::mutex> lock(generationMutex);
+                if (pendingGeneration.count(targetPos) != 0) continue;
+                pendingGeneration.insert(targetPos);
+            }
+            // Ключ - сам чанк: если игрок улетит, задача уедет в дальнюю корзину или отменится
+            JobSystem::Get().submit(JobClass::Generation, targetPos,
+                                    [targetPos] { generateChunkJob(targetPos); },
+                                    [targetPos] { onGenerationCancelled(targetPos); });
+            st.owned.insert(targetPos);
+            finderStats.loadRequests++;
+            tasksAdded++;
         }
 
-        // --- ВЫГРУЗКА ---
-        std::vector<glm::ivec3> toUnload;
-        auto chunkList = chunks.getSnapshot();
-        for (const auto& pair : chunkList) {
-            const glm::ivec3& chunkPos = pair.first;
-
-            int dist_x = abs(chunkPos.x - playerPos.x);
-            int dist_z = abs(chunkPos.z - playerPos.z);
-            int dist_y = abs(chunkPos.y - playerPos.y);
-
-            int horizontal_dist = std::max(dist_x, dist_z);
-
-            if (horizontal_dist > renderDistanceXZ + 2 || dist_y > renderHeightY + 2) {
-                toUnload.push_back(chunkPos);
+        // --- ВЫГРУЗКА: сначала самые дальние ---
+        const FinderBox keep = makeBox(playerPos, renderDistanceXZ + FINDER_KEEP_MARGIN, renderHeightY + FINDER_KEEP_MARGIN);
+        std::vector<glm::ivec3>& toUnload = st.scratch;
+        toUnload.clear();
+        for (int b = UNLOAD_BUCKETS - 1; b >= 0 && toUnload.size() < UNLOAD_PER_TICK; --b) {
+            auto& bucket = st.unloadBuckets[b];
+            while (!bucket.empty() && toUnload.size() < UNLOAD_PER_TICK) {
+                const glm::ivec3 pos = bucket.back();
+                bucket.pop_back();
+                if (inBox(keep, pos)) continue; // Игрок вернулся
+                if (st.owned.erase(pos) == 0 && !grid.contains(pos, chunks)) continue;
+                toUnload.push_back(pos);
             }
         }
 
         if (!toUnload.empty()) {
-            std::lock_guard<std::mutex> lock(unloadMutex);
-            for(const auto& pos : toUnload) {
-                if (chunks.tryGet(pos)) {
-                    unloadQueue.push(pos);
-                }
-            }
+            for (const auto& pos : toUnload) unloadQueue.push(glm::ivec3(pos), stopRequested);
+            finderStats.unloadRequests += toUnload.size();
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (tickStart - st.lastSweep >= FINDER_SWEEP_PERIOD) {
+            sweepOwned(st, chunks);
+            st.lastSweep = tickStart;
+        }
+
+        size_t candidates = 0;
+        for (const auto& bucket : st.unloadBuckets) candidates += bucket.size();
+        finderStats.pendingLoads = static_cast<uint32_t>(st.toLoad.size());
+        finderStats.unloadCandidates = static_cast<uint32_t>(candidates);
+        finderStats.lastTickUs = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tickStart).count());
+
+        if (tasksAdded > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        } else if (st.toLoad.empty() && candidates == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5)); // Все загружено, ждем движения игрока
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
     }
 }
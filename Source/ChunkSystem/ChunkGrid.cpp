@@ -0,0 +1,245 @@
+module;
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <glm/vec3.hpp>
+
+import Chunk;
+module ChunkGrid;
+
+// --- Эпохи читателей ---
+// Глобальные на все сетки: слот потока занимается при первом ReadGuard и
+// освобождается при выходе потока (JobSystem в cubeBench пересоздает воркеров).
+
+constexpr uint64_t READER_IDLE = std::numeric_limits<uint64_t>::max();
+
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{READER_IDLE}; // Эпоха входа или READER_IDLE
+    std::atomic<bool> taken{false};
+};
+
+static ReaderSlot readerSlots[GRID_READER_SLOTS];
+static std::atomic<uint64_t> globalEpoch{1};
+
+struct ReaderRegistration {
+    int slot = -1;
+    int depth = 0; // Вложенность ReadGuard
+
+    ~ReaderRegistration() {
+        if (slot >= 0) readerSlots[slot].taken.store(false, std::memory_order_release);
+    }
+};
+static thread_local ReaderRegistration reader;
+
+static int acquireReaderSlot() {
+    // Все слоты заняты - ждем выхода какого-нибудь потока
+    for (;;) {
+        for (int i = 0; i < GRID_READER_SLOTS; ++i) {
+            bool expected = false;
+            if (!readerSlots[i].taken.load(std::memory_order_relaxed) &&
+                readerSlots[i].taken.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return i;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+ChunkGrid::ReadGuard::ReadGuard() {
+    if (reader.depth++ > 0) return;
+    if (reader.slot < 0) reader.slot = acquireReaderSlot();
+    // acquire: увидев эпоху e, видим и все убирания из слотов до ее начала.
+    // Барьер: либо collectRetired увидит нашу эпоху, либо мы увидим пустые слоты.
+    readerSlots[reader.slot].epoch.store(globalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+ChunkGrid::ReadGuard::~ReadGuard() {
+    if (--reader.depth > 0) return;
+    readerSlots[reader.slot].epoch.store(READER_IDLE, std::memory_order_release);
+}
+
+static int nextPowerOfTwo(const int v) {
+    int p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+ChunkGrid::ChunkGrid(const int radiusXZ, const int radiusY)
+    : dimX(nextPowerOfTwo(2 * (radiusXZ + GRID_MARGIN) + 1)),
+      dimY(nextPowerOfTwo(2 * (radiusY + GRID_MARGIN) + 1)),
+      dimZ(dimX) {
+    maskX = dimX - 1;
+    maskY = dimY - 1;
+    maskZ = dimZ - 1;
+
+    const size_t count = static_cast<size_t>(dimX) * dimY * dimZ;
+    slots = std::make_unique<std::atomic<Chunk*>[]>(count);
+    for (size_t i = 0; i < count; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+    owners.resize(count);
+    storeWindow(target);
+}
+
+void boxDifference(const ChunkBox& from, const ChunkBox& to, std::vector<glm::ivec3>& out) {
+    struct Range { int lo, hi; };
+    auto intersect = [](Range a, Range b) { return Range{std::max(a.lo, b.lo), std::min(a.hi, b.hi)}; };
+    // a \ b - до двух отрезков
+    auto subtract = [](Range a, Range b, Range parts[2]) {
+        int n = 0;
+        if (a.lo > a.hi) return n;
+        if (b.hi < a.lo || b.lo > a.hi || b.lo > b.hi) { parts[n++] = a; return n; }
+        if (a.lo < b.lo) parts[n++] = {a.lo, b.lo - 1};
+        if (a.hi > b.hi) parts[n++] = {b.hi + 1, a.hi};
+        return n;
+    };
+    auto emit = [&out](Range rx, Range ry, Range rz) {
+        for (int x = rx.lo; x <= rx.hi; ++x)
+            for (int y = ry.lo; y <= ry.hi; ++y)
+                for (int z = rz.lo; z <= rz.hi; ++z)
+                    out.emplace_back(x, y, z);
+    };
+
+    if (to.lo.x > to.hi.x || to.lo.y > to.hi.y || to.lo.z > to.hi.z) return;
+    // Пустая from вычитает ничего: вся to
+    if (from.lo.x > from.hi.x || from.lo.y > from.hi.y || from.lo.z > from.hi.z) {
+        emit({to.lo.x, to.hi.x}, {to.lo.y, to.hi.y}, {to.lo.z, to.hi.z});
+        return;
+    }
+
+    const Range tx{to.lo.x, to.hi.x}, ty{to.lo.y, to.hi.y}, tz{to.lo.z, to.hi.z};
+    const Range fx{from.lo.x, from.hi.x}, fy{from.lo.y, from.hi.y}, fz{from.lo.z, from.hi.z};
+    Range parts[2];
+
+    for (int i = 0, n = subtract(tx, fx, parts); i < n; ++i) emit(parts[i], ty, tz);
+
+    const Range ix = intersect(tx, fx);
+    if (ix.lo > ix.hi) return;
+    for (int i = 0, n = subtract(ty, fy, parts); i < n; ++i) emit(ix, parts[i], tz);
+
+    const Range iy = intersect(ty, fy);
+    if (iy.lo > iy.hi) return;
+    for (int i = 0, n = subtract(tz, fz, parts); i < n; ++i) emit(ix, iy, parts[i]);
+}
+
+ChunkGrid::Box ChunkGrid::windowAround(const glm::ivec3& center) const {
+    // Полуоткрытое окно [center - dim/2, center + dim/2): ровно dim позиций на ось,
+    // значит внутри окна у каждого слота ровно одна координата
+    const glm::ivec3 half(dimX / 2, dimY / 2, dimZ / 2);
+    return {center - half, center + half - glm::ivec3(1)};
+}
+
+ChunkGrid::Box ChunkGrid::intersect(const Box& a, const Box& b) {
+    return {glm::ivec3(std::max(a.lo.x, b.lo.x), std::max(a.lo.y, b.lo.y), std::max(a.lo.z, b.lo.z)),
+            glm::ivec3(std::min(a.hi.x, b.hi.x), std::min(a.hi.y, b.hi.y), std::min(a.hi.z, b.hi.z))};
+}
+
+bool ChunkGrid::inBox(const Box& box, const glm::ivec3& pos) {
+    return pos.x >= box.lo.x && pos.x <= box.hi.x &&
+           pos.y >= box.lo.y && pos.y <= box.hi.y &&
+           pos.z >= box.lo.z && pos.z <= box.hi.z;
+}
+
+void ChunkGrid::storeWindow(const Box& box) {
+    const uint32_t seq = windowSeq.load(std::memory_order_relaxed);
+    windowSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int a = 0; a < 3; ++a) {
+        windowLo[a].store(box.lo[a], std::memory_order_relaxed);
+        windowHi[a].store(box.hi[a], std::memory_order_relaxed);
+    }
+    windowSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool ChunkGrid::inWindow(const glm::ivec3& pos) const {
+    // Seqlock: окно читается целиком из одной записи
+    Box box;
+    for (;;) {
+        const uint32_t seq = windowSeq.load(std::memory_order_acquire);
+        if (seq & 1) continue;
+        for (int a = 0; a < 3; ++a) {
+            box.lo[a] = windowLo[a].load(std::memory_order_relaxed);
+            box.hi[a] = windowHi[a].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (windowSeq.load(std::memory_order_relaxed) == seq) break;
+    }
+    return inBox(box, pos);
+}
+
+void ChunkGrid::retire(const size_t slot) {
+    if (owners[slot]) {
+        retired.push_back({std::move(owners[slot]), globalEpoch.load(std::memory_order_relaxed)});
+        owners[slot].reset();
+    }
+}
+
+bool ChunkGrid::publish(const std::shared_ptr<Chunk>& chunk) {
+    if (!chunk || !inBox(target, chunk->worldPosition)) return false;
+
+    const size_t slot = slotIndex(chunk->worldPosition);
+    Chunk* current = slots[slot].load(std::memory_order_relaxed);
+    if (current == chunk.get()) return true;
+    if (current && current->worldPosition != chunk->worldPosition && inBox(target, current->worldPosition)) {
+        return false; // Не бывает, пока окно больше зоны загрузки
+    }
+
+    retire(slot);
+    owners[slot] = chunk;
+    slots[slot].store(chunk.get(), std::memory_order_release);
+    return true;
+}
+
+void ChunkGrid::remove(const Chunk* chunk) {
+    if (!chunk) return;
+    const size_t slot = slotIndex(chunk->worldPosition);
+    if (slots[slot].load(std::memory_order_relaxed) != chunk) return;
+
+    slots[slot].store(nullptr, std::memory_order_release);
+    retire(slot);
+}
+
+void ChunkGrid::collectRetired() {
+    // Новая эпоха: кто войдет после этого, убранных до нее чанков уже не увидит
+    const uint64_t epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint64_t oldest = epoch;
+    for (const ReaderSlot& slot : readerSlots) {
+        oldest = std::min(oldest, slot.epoch.load(std::memory_order_acquire));
+    }
+    // Чанк, убранный в эпохе e, виден только читателям, вошедшим в эпохе <= e
+    std::erase_if(retired, [oldest](const Retired& r) { return r.epoch < oldest; });
+}
+
+bool ChunkGrid::contains(const glm::ivec3& pos, const ChunkMap& map) const {
+    if (inWindow(pos)) {
+        ReadGuard guard;
+        return tryGet(pos) != nullptr;
+    }
+    return map.contains(pos);
+}
+
+uint8_t getBlock(const glm::vec3 worldPos, const ChunkGrid& grid, const ChunkMap& chunks) {
+    const glm::ivec3 chunkIndex = getChunkIndex(worldPos);
+
+    int x = static_cast<int>(std::floor(worldPos.x)) & 31;
+    int y = static_cast<int>(std::floor(worldPos.y)) & 31;
+    int z = static_cast<int>(std::floor(worldPos.z)) & 31;
+
+    if (grid.inWindow(chunkIndex)) {
+        ChunkGrid::ReadGuard guard;
+        const Chunk* chunk = grid.tryGet(chunkIndex);
+        return chunk ? chunk->get(x, y, z) : 0;
+    }
+    auto ptr = chunks.tryGet(chunkIndex);
+    return ptr ? ptr->get(x, y, z) : 0;
+}
+
+bool isSolidBlock(const glm::vec3 pos, const ChunkGrid& grid, const ChunkMap& chunks) {
+    return getBlock(pos, grid, chunks) > 0;
+}
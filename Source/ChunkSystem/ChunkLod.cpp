@@ -0,0 +1,101 @@
+module;
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <glm/vec3.hpp>
+
+#include "../../Definitions/Core/Config.h"
+
+import PaddedVolume;
+module ChunkLod;
+
+int chunkRing(const glm::ivec3& chunk, const glm::ivec3& center) {
+    const glm::ivec3 d = chunk - center;
+    return std::max({std::abs(d.x), std::abs(d.y), std::abs(d.z)});
+}
+
+int lodStartRing(const int lod) {
+    return lodStartDistance << (lod - 1);
+}
+
+int selectLod(const int ring, const int current) {
+    if (lodStartDistance <= 0) return 0;
+    const int levels = std::clamp(lodLevels, 0, LOD_MAX);
+
+    // Грубее - сразу по порогу, детальнее - только с запасом в lodHysteresis колец
+    int lod = std::clamp(current, 0, levels);
+    while (lod < levels && ring >= lodStartRing(lod + 1)) ++lod;
+    while (lod > 0 && ring < lodStartRing(lod) - lodHysteresis) --lod;
+    return lod;
+}
+
+// Один слой рамки (внешний слой padded-массива по оси Axis): квадрат s x s,
+// в котором есть воздух, целиком становится воздухом
+template <int Axis>
+static void downsampleBorder(uint8_t* data, const int layer, const int s) {
+    auto at = [layer](const int u, const int v) {
+        if constexpr (Axis == 0) return PaddedVolume::idx(layer, u, v);
+        else if constexpr (Axis == 1) return PaddedVolume::idx(u, layer, v);
+        else return PaddedVolume::idx(u, v, layer);
+    };
+
+    for (int pv = 1; pv <= 32; pv += s) {
+        for (int pu = 1; pu <= 32; pu += s) {
+            bool full = true;
+            for (int v = pv; v < pv + s && full; ++v)
+                for (int u = pu; u < pu + s; ++u)
+                    if (data[at(u, v)] == 0) { full = false; break; }
+            if (full) continue;
+            for (int v = pv; v < pv + s; ++v)
+                for (int u = pu; u < pu + s; ++u) data[at(u, v)] = 0;
+        }
+    }
+}
+
+void downsampleVolume(PaddedVolume& volume, const int lod, const LodReduction mode) {
+    if (lod <= 0) return;
+    const int s = lodScale(std::min(lod, LOD_MAX));
+    const int cellVolume = s * s * s;
+    uint8_t* data = volume.data;
+
+    // Гистограмма ID сплошных блоков ячейки; сбрасываются только встреченные
+    uint16_t hist[256] = {};
+    uint8_t seen[256];
+
+    for (int cz = 1; cz <= 32; cz += s) {
+        for (int cy = 1; cy <= 32; cy += s) {
+            for (int cx = 1; cx <= 32; cx += s) {
+                int solid = 0, distinct = 0;
+                for (int z = cz; z < cz + s; ++z)
+                    for (int y = cy; y < cy + s; ++y) {
+                        const uint8_t* row = data + PaddedVolume::idx(cx, y, z);
+                        for (int x = 0; x < s; ++x) {
+                            const uint8_t b = row[x];
+                            if (b == 0) continue;
+                            ++solid;
+                            if (hist[b]++ == 0) seen[distinct++] = b;
+                        }
+                    }
+
+                const bool keep = mode == LodReduction::AnySolid ? solid > 0 : 2 * solid >= cellVolume;
+                uint8_t block = 0;
+                uint16_t best = 0;
+                for (int i = 0; i < distinct; ++i) {
+                    const uint8_t b = seen[i];
+                    if (keep && hist[b] > best) { best = hist[b]; block = b; }
+                    hist[b] = 0;
+                }
+
+                for (int z = cz; z < cz + s; ++z)
+                    for (int y = cy; y < cy + s; ++y) std::memset(data + PaddedVolume::idx(cx, y, z), block, s);
+            }
+        }
+    }
+
+    for (const int layer : {0, PADDED_SIZE - 1}) {
+        downsampleBorder<0>(data, layer, s);
+        downsampleBorder<1>(data, layer, s);
+        downsampleBorder<2>(data, layer, s);
+    }
+}
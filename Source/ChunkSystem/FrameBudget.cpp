@@ -0,0 +1,33 @@
+module;
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+module FrameBudget;
+
+// Вес нового замера в EMA: ~10 последних элементов
+constexpr double EMA_ALPHA = 0.1;
+
+void StageBudget::begin(const int budgetUs) {
+    start = Clock::now();
+    budget = static_cast<double>(std::max(0, budgetUs));
+    processed = 0;
+}
+
+bool StageBudget::canTake(const double weight) const {
+    if (processed == 0) return true;
+    const double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    return elapsed + emaCostUs * weight <= budget;
+}
+
+void StageBudget::record(const Clock::time_point t0, const double weight) {
+    const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    const double perUnit = us / std::max(weight, 1e-3);
+    emaCostUs += (perUnit - emaCostUs) * EMA_ALPHA;
+    processed++;
+}
+
+void StageBudget::end() {
+    processedLastFrame = processed;
+    spentLastFrameUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
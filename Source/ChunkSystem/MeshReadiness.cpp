@@ -0,0 +1,95 @@
+module;
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec3.hpp>
+
+import Chunk;
+import ChunkGrid;
+module MeshReadiness;
+
+static const glm::ivec3 FACE_OFFSETS[6] = {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}
+};
+
+void MeshReadiness::markDirty(const std::shared_ptr<Chunk>& chunk, const bool alreadyQueued) {
+    counters.marks++;
+    if (alreadyQueued) {
+        counters.merged++;
+        return;
+    }
+
+    const glm::ivec3 pos = chunk->worldPosition;
+    if (auto it = waiting.find(pos); it != waiting.end()) {
+        counters.merged++;
+        it->second.chunk = chunk; // Чанк мог замениться (правка игрока)
+        return;
+    }
+
+    waiting.emplace(pos, Waiting{chunk, Clock::now()});
+    recheck.push_back(pos);
+}
+
+void MeshReadiness::neighbourArrived(const glm::ivec3& pos) {
+    for (const auto& o : FACE_OFFSETS) {
+        if (waiting.contains(pos + o)) recheck.push_back(pos + o);
+    }
+}
+
+void MeshReadiness::forget(const glm::ivec3& pos) {
+    waiting.erase(pos);
+}
+
+bool MeshReadiness::neighboursReady(const glm::ivec3& pos, const ChunkMap& map,
+                                    const ChunkGrid* grid, const LoadBox& box) {
+    for (const auto& o : FACE_OFFSETS) {
+        const glm::ivec3 n = pos + o;
+        if (!box.contains(n)) continue; // Этот сосед не придет - граница мира загрузки
+        const bool present = grid ? grid->contains(n, map) : map.contains(n);
+        if (!present) return false;
+    }
+    return true;
+}
+
+void MeshReadiness::collectReady(const ChunkMap& map, const ChunkGrid* grid, const LoadBox& box,
+                                 const Clock::time_point now, std::vector<std::shared_ptr<Chunk>>& out) {
+    // 1. Затронутые с прошлого раза (новые пометки и соседи пришедших чанков)
+    for (const auto& pos : recheck) {
+        auto it = waiting.find(pos);
+        if (it == waiting.end()) continue;
+        if (neighboursReady(pos, map, grid, box)) {
+            out.push_back(std::move(it->second.chunk));
+            waiting.erase(it);
+            counters.released++;
+        } else if (!it->second.deferred) {
+            it->second.deferred = true;
+            counters.deferred++;
+        }
+    }
+    recheck.clear();
+
+    // 2. Редкий обход всех ждущих: таймаут и соседи, ушедшие за зону загрузки
+    if (waiting.empty() || now - lastTimeoutScan < timeout / 4) return;
+    lastTimeoutScan = now;
+
+    for (auto it = waiting.begin(); it != waiting.end();) {
+        const bool ready = neighboursReady(it->first, map, grid, box);
+        const bool expired = now - it->second.since >= timeout;
+        if (ready || expired) {
+            out.push_back(std::move(it->second.chunk));
+            counters.released++;
+            if (!ready) counters.timedOut++;
+            it = waiting.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+MeshReadinessStats MeshReadiness::stats() const {
+    MeshReadinessStats s = counters;
+    s.waiting = waiting.size();
+    return s;
+}
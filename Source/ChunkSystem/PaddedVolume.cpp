@@ -0,0 +1,128 @@
+module;
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <glm/vec3.hpp>
+
+import Chunk;
+import ChunkGrid;
+module PaddedVolume;
+
+void fetchNeighborhood(const glm::ivec3& pos, const ChunkMap& map, ChunkNeighborhood& out, const ChunkGrid* grid) {
+    out.chunks.fill(nullptr);
+
+    // Весь куб 3x3x3 в окне сетки - обходимся без карты
+    if (grid && grid->inWindow(pos - glm::ivec3(1)) && grid->inWindow(pos + glm::ivec3(1))) {
+        for (int dz = -1; dz <= 1; ++dz)
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx == 0 && dy == 0 && dz == 0) continue;
+                    out.chunks[ChunkNeighborhood::index(dx, dy, dz)] = grid->tryGet(pos + glm::ivec3(dx, dy, dz));
+                }
+        return;
+    }
+
+    std::array<glm::ivec3, 26> keys;
+    std::array<int, 26> slots;
+    int n = 0;
+    for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0 && dz == 0) continue;
+                keys[n] = pos + glm::ivec3(dx, dy, dz);
+                slots[n] = ChunkNeighborhood::index(dx, dy, dz);
+                ++n;
+            }
+
+    std::array<std::shared_ptr<Chunk>, 26> found;
+    map.tryGetMany(keys.data(), found.data(), keys.size());
+
+    for (int i = 0; i < n; ++i) {
+        out.chunks[slots[i]] = found[i].get();
+        out.owners[slots[i]] = std::move(found[i]);
+    }
+}
+
+// Откуда брать слой соседа по одной оси: -1 -> его слой 31 в наш 0,
+// +1 -> его слой 0 в наш 33, 0 -> весь диапазон 0..31 в 1..32.
+static constexpr int srcLayer(int d) { return d < 0 ? 31 : 0; }
+static constexpr int dstLayer(int d) { return d < 0 ? 0 : 33; }
+
+// 32 блока соседа от from с шагом step (вдоль Y или Z) в dst с шагом dstStride.
+// Грани X и ребра вдоль Y/Z - это столбцы: каждый байт лежит в своей строке X
+// и с обеих сторон идет с шагом 32/1024 и 34/1156. SIMD тут свелся бы к
+// gather + scatter с одним полезным байтом на строку и не выигрывает у
+// скалярного цикла; к тому же это ~4.5 КБ из 39 КБ объема, основное время
+// уходит на memset и строки центра. Поэтому только без вызовов get() там, где
+// можно: однородный сосед - заливка, плоский буфер - прямое чтение по шагу.
+static void copyColumn(uint8_t* dst, int dstStride, const Chunk& nb, glm::ivec3 from, glm::ivec3 step) {
+    if (nb.isUniform()) {
+        for (int i = 0; i < 32; ++i) dst[i * dstStride] = nb.uniformBlock;
+        return;
+    }
+    if (const uint8_t* src = nb.data()) {
+        const uint8_t* column = src + from.x + from.y * 32 + from.z * 1024;
+        const int srcStride = step.y * 32 + step.z * 1024;
+        for (int i = 0; i < 32; ++i) dst[i * dstStride] = column[i * srcStride];
+        return;
+    }
+    for (int i = 0; i < 32; ++i) {
+        const glm::ivec3 p = from + step * i;
+        dst[i * dstStride] = nb.get(p.x, p.y, p.z);
+    }
+}
+
+void PaddedVolume::build(const Chunk* center, const ChunkNeighborhood& nb) {
+    // Очищаем нулями (воздух)
+    std::memset(data, 0, sizeof(data));
+    if (!center) return;
+
+    // 1. Центр (32x32x32) в середину (смещение 1,1,1), строками X
+    for (int z = 0; z < 32; ++z)
+        for (int y = 0; y < 32; ++y)
+            center->copyRow(y, z, &data[idx(1, y + 1, z + 1)]);
+
+    // 2. Грани Y и Z - тоже целыми строками X
+    for (int dy : {-1, 1}) {
+        if (const Chunk* c = nb.at(0, dy, 0)) {
+            for (int z = 0; z < 32; ++z) c->copyRow(srcLayer(dy), z, &data[idx(1, dstLayer(dy), z + 1)]);
+        }
+    }
+    for (int dz : {-1, 1}) {
+        if (const Chunk* c = nb.at(0, 0, dz)) {
+            for (int y = 0; y < 32; ++y) c->copyRow(y, srcLayer(dz), &data[idx(1, y + 1, dstLayer(dz))]);
+        }
+    }
+
+    // 3. Грани X - столбцы по Y (см. copyColumn)
+    for (int dx : {-1, 1}) {
+        if (const Chunk* c = nb.at(dx, 0, 0)) {
+            for (int z = 0; z < 32; ++z)
+                copyColumn(&data[idx(dstLayer(dx), 1, z + 1)], PADDED_SIZE, *c, glm::ivec3(srcLayer(dx), 0, z),
+                           glm::ivec3(0, 1, 0));
+        }
+    }
+
+    // 4. Ребра (32 блока) и углы (1 блок)
+    for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int zeros = (dx == 0) + (dy == 0) + (dz == 0);
+                if (zeros >= 2) continue; // центр и грани уже заполнены
+                const Chunk* c = nb.at(dx, dy, dz);
+                if (!c) continue;
+
+                if (zeros == 0) {
+                    data[idx(dstLayer(dx), dstLayer(dy), dstLayer(dz))] = c->get(srcLayer(dx), srcLayer(dy), srcLayer(dz));
+                } else if (dx == 0) {
+                    c->copyRow(srcLayer(dy), srcLayer(dz), &data[idx(1, dstLayer(dy), dstLayer(dz))]);
+                } else if (dy == 0) {
+                    copyColumn(&data[idx(dstLayer(dx), 1, dstLayer(dz))], PADDED_SIZE, *c,
+                               glm::ivec3(srcLayer(dx), 0, srcLayer(dz)), glm::ivec3(0, 1, 0));
+                } else {
+                    copyColumn(&data[idx(dstLayer(dx), dstLayer(dy), 1)], PADDED_SIZE * PADDED_SIZE, *c,
+                               glm::ivec3(srcLayer(dx), srcLayer(dy), 0), glm::ivec3(0, 0, 1));
+                }
+            }
+}
@@ -0,0 +1,125 @@
+// Ядро векторной раскраски рельефа (classifyBlocks), общее для всех наборов
+// инструкций. Шаблон по архитектуре xsimd: TerrainKernels.cpp выбирает лучшую
+// при запуске (xsimd::dispatch), а экземпляр для AVX2 собирается в отдельном
+// файле со своими флагами (TerrainClassifyAvx2.cpp).
+// Не модуль: файлам архитектур нужны свои флаги компиляции, а интерфейс модуля
+// TerrainKernels собирается один раз.
+// Ядро в анонимном пространстве имен: у каждого файла своя копия со своими флагами,
+// и компоновщик не может подставить код из файла с -mavx2 в базовый (ODR).
+
+#ifndef TERRAIN_CLASSIFY_HPP
+#define TERRAIN_CLASSIFY_HPP
+
+#include <cstdint>
+#include <xsimd/xsimd.hpp>
+
+#include "../../Definitions/Core/Constants.hpp"
+
+// Параметры раскраски рельефа
+constexpr float DENSITY_THRESHOLD = 0.0f;
+constexpr int DIRT_THICKNESS = 3;
+constexpr float GRADIENT_STEP = 1.0f / 64.0f;
+
+// Страйды для HighRes массива 32x33x32 (NOISE_HR_*, сверяется в TerrainKernels.cpp)
+constexpr int NR_STRIDE_Y = 32;
+constexpr int NR_STRIDE_Z = 32 * 33;
+
+namespace {
+
+// Линейная версия раскраски. Состояние колонки (плотность сверху и остаток земли)
+// хранится во float-линиях: глубина 0..3 представима точно, select вместо веток.
+struct ClassifyBlocksKernel {
+    template <class Arch>
+    void operator()(Arch, const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth) const;
+};
+
+template <class Arch>
+void ClassifyBlocksKernel::operator()(Arch, const float* highRes, int startY, int seaLevel, uint8_t* blocks,
+                                      uint8_t* dirtDepth) const {
+    using batch = xsimd::batch<float, Arch>;
+    constexpr int B = static_cast<int>(batch::size);
+    static_assert(32 % B == 0, "batch width must divide 32");
+
+    alignas(64) float above[32];
+    alignas(64) float depth[32];
+    alignas(64) float rowBlocks[32];
+
+    const batch threshold(DENSITY_THRESHOLD);
+    const batch zero(0.0f);
+    const batch one(1.0f);
+    const batch dirtThickness(static_cast<float>(DIRT_THICKNESS));
+    const batch grassId(static_cast<float>(BLOCK_GRASS));
+    const batch dirtId(static_cast<float>(BLOCK_DIRT));
+    const batch stoneId(static_cast<float>(BLOCK_STONE));
+    const batch airId(static_cast<float>(BLOCK_AIR));
+
+    for (int z = 0; z < CHUNK_SIZE_Z; ++z) {
+        const float* noiseZPtr = highRes + z * NR_STRIDE_Z;
+        uint8_t* blockZPtr = blocks + (z * 32 * 32);
+
+        // 1. Инициализация по Y=32
+        {
+            const float* noiseTopRow = noiseZPtr + (32 * NR_STRIDE_Y);
+            float worldYTop = (float)(startY + CHUNK_SIZE_Y);
+            const batch gradientTop((seaLevel - worldYTop) * GRADIENT_STEP);
+
+            for (int x = 0; x < 32; x += B) {
+                (batch::load_unaligned(noiseTopRow + x) + gradientTop).store_aligned(above + x);
+                zero.store_aligned(depth + x);
+            }
+            if (dirtDepth) {
+                for (int x = 0; x < 32; ++x) depth[x] = static_cast<float>(dirtDepth[z * 32 + x]);
+            }
+        }
+
+        // 2. Цикл вниз: вся строка X за раз, колонки - линии
+        for (int y = CHUNK_SIZE_Y - 1; y >= 0; --y) {
+            const float* noiseRowPtr = noiseZPtr + (y * NR_STRIDE_Y);
+            float worldY = (float)(startY + y);
+            const batch rowGradient((seaLevel - worldY) * GRADIENT_STEP);
+
+            for (int x = 0; x < 32; x += B) {
+                batch cur = batch::load_unaligned(noiseRowPtr + x) + rowGradient;
+                batch up = batch::load_aligned(above + x);
+                batch dep = batch::load_aligned(depth + x);
+
+                auto solid = cur > threshold;
+                auto grass = solid & (up <= threshold);
+                auto dirt = solid & !(up <= threshold) & (dep > zero);
+
+                batch block = xsimd::select(grass, grassId,
+                              xsimd::select(dirt, dirtId,
+                              xsimd::select(solid, stoneId, airId)));
+                batch newDepth = xsimd::select(grass, dirtThickness,
+                                 xsimd::select(dirt, dep - one,
+                                 xsimd::select(solid, dep, zero)));
+
+                block.store_aligned(rowBlocks + x);
+                newDepth.store_aligned(depth + x);
+                cur.store_aligned(above + x);
+            }
+
+            // Сужение float -> uint8 (компилятор сам векторизует)
+            uint8_t* blockRowPtr = blockZPtr + (y * 32);
+            for (int x = 0; x < 32; ++x) blockRowPtr[x] = static_cast<uint8_t>(rowBlocks[x]);
+        }
+
+        // 3. Остаток земли уходит в чанк ниже
+        if (dirtDepth) {
+            for (int x = 0; x < 32; ++x) dirtDepth[z * 32 + x] = static_cast<uint8_t>(depth[x]);
+        }
+    }
+}
+
+} // namespace
+
+#if defined(TERRAIN_CLASSIFY_DISPATCH)
+// Кандидаты для xsimd::dispatch, от лучшего к базовому. Базовый (SSE4.2, он же
+// -march=x86-64-v2 всего cubeCore) собирается в TerrainKernels.cpp, AVX2 - в своем файле.
+using TerrainClassifyArchs = xsimd::arch_list<xsimd::avx2, xsimd::sse4_2>;
+
+// Обычная функция вместо экземпляра шаблона: наружу из файла с -mavx2 выходит только она
+void classifyBlocksAvx2(const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth);
+#endif
+
+#endif // TERRAIN_CLASSIFY_HPP
@@ -0,0 +1,8 @@
+// Раскраска рельефа для AVX2 (собирается с -mavx2, см. CMakeLists.txt).
+// Вызывается только через xsimd::dispatch, если процессор это поддерживает.
+
+#include "TerrainClassify.hpp"
+
+void classifyBlocksAvx2(const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth) {
+    ClassifyBlocksKernel{}(xsimd::avx2{}, highRes, startY, seaLevel, blocks, dirtDepth);
+}
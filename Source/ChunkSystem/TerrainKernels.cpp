@@ -0,0 +1,358 @@
+module;
+
+#include <cstdint>
+#include <cstring>
+#include <xsimd/xsimd.hpp>
+
+#include "../../Definitions/Core/Constants.hpp"
+#include "TerrainClassify.hpp"
+
+module TerrainKernels;
+
+static_assert(NR_STRIDE_Y == NOISE_HR_X && NR_STRIDE_Z == NOISE_HR_X * NOISE_HR_Y, "TerrainClassify.hpp strides");
+
+// Вспомогательная функция линейной интерполяции (LERP)
+static inline float lerp(float a, float b, float t) {
+    return a + t * (b - a);
+}
+
+void upscaleNoiseScalar(const float* lowRes, float* highRes) {
+    constexpr int LR_XZ = NOISE_LR_XZ;
+    constexpr int LR_Y  = NOISE_LR_Y;
+    constexpr int HR_X = NOISE_HR_X;
+    constexpr int HR_Y = NOISE_HR_Y;
+    constexpr int HR_Z = NOISE_HR_Z;
+
+    // i, k идут до 16. j (по Y) идет до 17.
+    for (int k = 0; k < LR_XZ - 1; ++k) {     // Z
+        for (int j = 0; j < LR_Y - 1; ++j) {  // Y (17 итераций)
+            for (int i = 0; i < LR_XZ - 1; ++i) { // X
+
+                // Индексы LowRes (X -> Y -> Z)
+                int idx000 = (i)     + (j)     * LR_XZ + (k)     * (LR_XZ * LR_Y);
+                int idx100 = (i + 1) + (j)     * LR_XZ + (k)     * (LR_XZ * LR_Y);
+                int idx010 = (i)     + (j + 1) * LR_XZ + (k)     * (LR_XZ * LR_Y);
+                int idx110 = (i + 1) + (j + 1) * LR_XZ + (k)     * (LR_XZ * LR_Y);
+
+                int strideZ = LR_XZ * LR_Y; // Смещение на один шаг по Z в LowRes
+                int idx001 = idx000 + strideZ;
+                int idx101 = idx100 + strideZ;
+                int idx011 = idx010 + strideZ;
+                int idx111 = idx110 + strideZ;
+
+                float v000 = lowRes[idx000]; float v100 = lowRes[idx100];
+                float v010 = lowRes[idx010]; float v110 = lowRes[idx110];
+                float v001 = lowRes[idx001]; float v101 = lowRes[idx101];
+                float v011 = lowRes[idx011]; float v111 = lowRes[idx111];
+
+                int xBase = i * 2;
+                int yBase = j * 2;
+                int zBase = k * 2;
+
+                for (int zOff = 0; zOff < 2; zOff++) {
+                    int hZ = zBase + zOff;
+                    if (hZ >= HR_Z) continue;
+
+                    float tZ = zOff * 0.5f;
+                    float c00 = lerp(v000, v001, tZ);
+                    float c10 = lerp(v100, v101, tZ);
+                    float c01 = lerp(v010, v011, tZ);
+                    float c11 = lerp(v110, v111, tZ);
+
+                    for (int yOff = 0; yOff < 2; yOff++) {
+                        int hY = yBase + yOff;
+                        if (hY >= HR_Y) continue; // Защита (до 33)
+
+                        float tY = yOff * 0.5f;
+                        float c0 = lerp(c00, c01, tY);
+                        float c1 = lerp(c10, c11, tY);
+
+                        for (int xOff = 0; xOff < 2; xOff++) {
+                            float val = lerp(c0, c1, xOff * 0.5f);
+
+                            // Индекс: x + y*32 + z*32*33
+                            int hIdx = (xBase + xOff) + hY * HR_X + hZ * HR_X * HR_Y;
+                            highRes[hIdx] = val;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void classifyBlocksScalar(const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth) {
+    // Временные буферы
+    float rowDensitiesAbove[32];
+    uint8_t rowDirtDepth[32];
+
+    for (int z = 0; z < CHUNK_SIZE_Z; ++z) {
+        const float* noiseZPtr = highRes + z * NR_STRIDE_Z;
+        uint8_t* blockZPtr = blocks + (z * 32 * 32);
+
+        // 1. Инициализация по Y=32 (33-й слой апскейла)
+        {
+            const float* noiseTopRow = noiseZPtr + (32 * NR_STRIDE_Y);
+            float worldYTop = (float)(startY + CHUNK_SIZE_Y);
+            float gradientTop = (seaLevel - worldYTop) * GRADIENT_STEP;
+
+            for (int x = 0; x < 32; ++x) {
+                rowDensitiesAbove[x] = noiseTopRow[x] + gradientTop;
+                rowDirtDepth[x] = dirtDepth ? dirtDepth[z * 32 + x] : 0;
+            }
+        }
+
+        // 2. Цикл вниз
+        for (int y = CHUNK_SIZE_Y - 1; y >= 0; --y) {
+            const float* noiseRowPtr = noiseZPtr + (y * NR_STRIDE_Y);
+            uint8_t* blockRowPtr = blockZPtr + (y * 32);
+            float worldY = (float)(startY + y);
+            float rowGradient = (seaLevel - worldY) * GRADIENT_STEP;
+
+            for (int x = 0; x < 32; ++x) {
+                float currentDensity = noiseRowPtr[x] + rowGradient;
+                float densityUp = rowDensitiesAbove[x];
+
+                uint8_t blockType;
+                if (currentDensity > DENSITY_THRESHOLD) {
+                    // Если сверху пусто -> это трава
+                    if (densityUp <= DENSITY_THRESHOLD) {
+                        blockType = BLOCK_GRASS;
+                        rowDirtDepth[x] = DIRT_THICKNESS;
+                    }
+                    // Если сверху блок и есть запас земли -> земля
+                    else if (rowDirtDepth[x] > 0) {
+                        blockType = BLOCK_DIRT;
+                        rowDirtDepth[x]--;
+                    }
+                    // Иначе камень
+                    else {
+                        blockType = BLOCK_STONE;
+                    }
+                } else {
+                    blockType = BLOCK_AIR;
+                    rowDirtDepth[x] = 0;
+                }
+
+                blockRowPtr[x] = blockType;
+                rowDensitiesAbove[x] = currentDensity;
+            }
+        }
+
+        // 3. Остаток земли уходит в чанк ниже
+        if (dirtDepth) std::memcpy(dirtDepth + z * 32, rowDirtDepth, 32);
+    }
+}
+
+void dirtCarryFromAbove(const float* lowRes, const int strideZ, const int startY, const int seaLevel,
+                        uint8_t* dirtDepth) {
+    // Остаток земли на дне чанка ненулевой, только если трава не выше строки
+    // DIRT_THICKNESS - 1: каждая твердая строка ниже травы съедает единицу, воздух
+    // обнуляет. Поэтому хватает строк 0..DIRT_THICKNESS апскейла (узлы 0..2),
+    // а раскраска начинается с нулевым остатком - более высокая трава сюда не дотянется.
+    constexpr int ROWS = DIRT_THICKNESS + 1;
+    static_assert((ROWS - 1) / 2 + 1 < NOISE_LR_Y, "carry rows must fit the chunk's low-res grid");
+
+    float density[ROWS][32];
+    float yRow[NOISE_LR_XZ];
+
+    for (int z = 0; z < CHUNK_SIZE_Z; ++z) {
+        // Тот же порядок Z -> Y -> X и та же формула, что у upscaleNoise: значения совпадают побитово
+        const float* planeA = lowRes + (z >> 1) * strideZ;
+        const float* planeB = planeA + strideZ;
+        const float tZ = (z & 1) * 0.5f;
+
+        for (int hy = 0; hy < ROWS; ++hy) {
+            const int rowA = (hy >> 1) * NOISE_LR_XZ;
+            const int rowB = rowA + NOISE_LR_XZ;
+            const float tY = (hy & 1) * 0.5f;
+            for (int i = 0; i < NOISE_LR_XZ; ++i) {
+                yRow[i] = lerp(lerp(planeA[rowA + i], planeB[rowA + i], tZ),
+                               lerp(planeA[rowB + i], planeB[rowB + i], tZ), tY);
+            }
+
+            const float gradient = (seaLevel - (float)(startY + hy)) * GRADIENT_STEP;
+            for (int x = 0; x < 32; ++x) {
+                density[hy][x] = lerp(yRow[x >> 1], yRow[(x >> 1) + 1], (x & 1) * 0.5f) + gradient;
+            }
+        }
+
+        // Те же правила, что в classifyBlocksScalar, но без записи блоков
+        for (int x = 0; x < 32; ++x) {
+            float above = density[ROWS - 1][x];
+            uint8_t depth = 0;
+            for (int y = ROWS - 2; y >= 0; --y) {
+                const float cur = density[y][x];
+                if (cur > DENSITY_THRESHOLD) {
+                    if (above <= DENSITY_THRESHOLD) depth = DIRT_THICKNESS;
+                    else if (depth > 0) depth--;
+                } else {
+                    depth = 0;
+                }
+                above = cur;
+            }
+            dirtDepth[z * 32 + x] = depth;
+        }
+    }
+}
+
+void classifyBlocksCoarse(const float* coarse, const int step, const int startY, const int seaLevel, uint8_t* blocks) {
+    const int n = CHUNK_SIZE_X / step;
+    const int strideY = n, strideZ = n * (n + 1);
+    // Земля под травой - в целых ячейках (не тоньше, чем в полном разрешении)
+    const int dirtCells = (DIRT_THICKNESS + step - 1) / step;
+    const float gradientTop = (seaLevel - (float)(startY + CHUNK_SIZE_Y)) * GRADIENT_STEP;
+
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            const float* column = coarse + x + z * strideZ;
+            float densityUp = column[n * strideY] + gradientTop;
+            int dirtDepth = 0;
+
+            for (int y = n - 1; y >= 0; --y) {
+                const float density = column[y * strideY] + (seaLevel - (float)(startY + y * step)) * GRADIENT_STEP;
+
+                uint8_t blockType;
+                if (density > DENSITY_THRESHOLD) {
+                    if (densityUp <= DENSITY_THRESHOLD) {
+                        blockType = BLOCK_GRASS;
+                        dirtDepth = dirtCells;
+                    } else if (dirtDepth > 0) {
+                        blockType = BLOCK_DIRT;
+                        dirtDepth--;
+                    } else {
+                        blockType = BLOCK_STONE;
+                    }
+                } else {
+                    blockType = BLOCK_AIR;
+                    dirtDepth = 0;
+                }
+                densityUp = density;
+
+                // Ячейка step^3 - строками X
+                for (int dz = 0; dz < step; ++dz)
+                    for (int dy = 0; dy < step; ++dy)
+                        std::memset(blocks + x * step + (y * step + dy) * 32 + (z * step + dz) * 1024, blockType, step);
+            }
+        }
+    }
+}
+
+#if defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+
+void upscaleNoise(const float* lowRes, float* highRes) {
+    upscaleNoiseScalar(lowRes, highRes);
+}
+
+void classifyBlocks(const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth) {
+    classifyBlocksScalar(highRes, startY, seaLevel, blocks, dirtDepth);
+}
+
+const char* classifyBlocksArch() {
+    return "scalar";
+}
+
+#else
+
+void upscaleNoise(const float* lowRes, float* highRes) {
+    using batch = xsimd::batch<float>;
+    constexpr int B = static_cast<int>(batch::size);
+
+    constexpr int LR_XZ = NOISE_LR_XZ;
+    constexpr int LR_PLANE = NOISE_LR_XZ * NOISE_LR_Y; // 306 точек на один слой Z
+    constexpr int HR_X = NOISE_HR_X;
+    constexpr int HR_PLANE = NOISE_HR_X * NOISE_HR_Y;
+
+    // Половина строки X (16 пар) должна делиться на ширину батча
+    static_assert((NOISE_LR_XZ - 1) % B == 0, "batch width must divide 16");
+
+    // Промежуточные строки живут на стеке и целиком помещаются в L1
+    alignas(64) float zPlane[LR_PLANE];
+    alignas(64) float yRow[LR_XZ];
+
+    const batch half(0.5f);
+
+    for (int hz = 0; hz < NOISE_HR_Z; ++hz) {
+        // --- Проход Z: слой k и k+1 -> один слой 17x18 ---
+        const float* planeA = lowRes + (hz >> 1) * LR_PLANE;
+        const float* planeB = planeA + LR_PLANE;
+        const float tZs = (hz & 1) * 0.5f;
+        const batch tZ(tZs);
+
+        int n = 0;
+        for (; n + B <= LR_PLANE; n += B) {
+            batch a = batch::load_unaligned(planeA + n);
+            batch b = batch::load_unaligned(planeB + n);
+            (a + tZ * (b - a)).store_aligned(zPlane + n);
+        }
+        for (; n < LR_PLANE; ++n) zPlane[n] = lerp(planeA[n], planeB[n], tZs);
+
+        float* outZ = highRes + hz * HR_PLANE;
+
+        for (int hy = 0; hy < NOISE_HR_Y; ++hy) {
+            // --- Проход Y: строки j и j+1 -> одна строка из 17 точек ---
+            const float* rowA = zPlane + (hy >> 1) * LR_XZ;
+            const float* rowB = rowA + LR_XZ;
+            const float tYs = (hy & 1) * 0.5f;
+            const batch tY(tYs);
+
+            int i = 0;
+            for (; i + B <= LR_XZ; i += B) {
+                batch a = batch::load_unaligned(rowA + i);
+                batch b = batch::load_unaligned(rowB + i);
+                (a + tY * (b - a)).store_aligned(yRow + i);
+            }
+            for (; i < LR_XZ; ++i) yRow[i] = lerp(rowA[i], rowB[i], tYs);
+
+            // --- Проход X: четные точки = узлы, нечетные = середины, чередуем zip'ом ---
+            float* outRow = outZ + hy * HR_X;
+            for (int x = 0; x < LR_XZ - 1; x += B) {
+                batch a = batch::load_aligned(yRow + x);
+                batch b = batch::load_unaligned(yRow + x + 1);
+                batch d = b - a;
+                batch even = a + batch(0.0f) * d; // Та же формула, что и в lerp(a, b, 0)
+                batch odd = a + half * d;
+                xsimd::zip_lo(even, odd).store_unaligned(outRow + 2 * x);
+                xsimd::zip_hi(even, odd).store_unaligned(outRow + 2 * x + B);
+            }
+        }
+    }
+}
+
+#if defined(TERRAIN_CLASSIFY_DISPATCH)
+
+// Перегрузка на каждую архитектуру списка: AVX2 - из своего файла, базовая - отсюда
+struct ClassifyBlocksDispatch {
+    void operator()(xsimd::avx2, const float* highRes, int startY, int seaLevel, uint8_t* blocks,
+                    uint8_t* dirtDepth) const {
+        classifyBlocksAvx2(highRes, startY, seaLevel, blocks, dirtDepth);
+    }
+    void operator()(xsimd::sse4_2, const float* highRes, int startY, int seaLevel, uint8_t* blocks,
+                    uint8_t* dirtDepth) const {
+        ClassifyBlocksKernel{}(xsimd::sse4_2{}, highRes, startY, seaLevel, blocks, dirtDepth);
+    }
+};
+
+void classifyBlocks(const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth) {
+    // Лучший набор инструкций процессора выбирается при первом вызове
+    static const auto dispatched = xsimd::dispatch<TerrainClassifyArchs>(ClassifyBlocksDispatch{});
+    dispatched(highRes, startY, seaLevel, blocks, dirtDepth);
+}
+
+const char* classifyBlocksArch() {
+    return xsimd::available_architectures().avx2 ? xsimd::avx2::name() : xsimd::sse4_2::name();
+}
+
+#else
+
+void classifyBlocks(const float* highRes, int startY, int seaLevel, uint8_t* blocks, uint8_t* dirtDepth) {
+    ClassifyBlocksKernel{}(xsimd::default_arch{}, highRes, startY, seaLevel, blocks, dirtDepth);
+}
+
+const char* classifyBlocksArch() {
+    return xsimd::default_arch::name();
+}
+
+#endif
+
+#endif
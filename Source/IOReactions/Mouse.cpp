@@ -16,8 +16,9 @@ void MouseInteractions::set(int x, int y, int z, uint8_t block, const std::share
     if (x < 0 || y < 0 || z < 0 || x >= 32 || y >= 32 || z >= 32) return;
 
     // Убираем const, чтобы можно было менять данные
+    // set() сам развернет однородный чанк в буфер
     Chunk* temp = chunk.get();
-    temp->blocks[x + (y << 5) + (z << 10)] = block;
+    temp->set(x, y, z, block);
     temp->needsMeshUpdate = false; // Ставим флаг прямо здесь
 }
 
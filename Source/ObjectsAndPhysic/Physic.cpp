@@ -11,6 +11,7 @@ import Keyboard;
 import AABB;
 import Mouse;
 import Chunk;
+import ChunkGrid;
 import Window;
 import Camera;
 
@@ -24,10 +25,10 @@ module Physic;
     }
 
 
-    void Physic::makeTick(Keyboard &keyboard_control,std::vector<std::shared_ptr<Chunk>> &batchG, Camera &camera, const double dt,ChunkMap &chunkMap, const Window &window) {
+    void Physic::makeTick(Keyboard &keyboard_control,std::vector<std::shared_ptr<Chunk>> &batchG, Camera &camera, const double dt,ChunkMap &chunkMap, const ChunkGrid &grid, const Window &window) {
 
         keyboard_control.keyboardControlNotFree(&camera, window.window,dt,&kineticVector, onGround, legsPower,moveSpeed);
-        movePlayer(*playerAABB, kineticVector,dt, onGround,chunkMap );
+        movePlayer(*playerAABB, kineticVector,dt, onGround,chunkMap, grid);
 
         if (onGround) {
             kineticVector -= kineticVector * 0.91f * (static_cast<float>(dt/(dt+0.005f)));
@@ -50,7 +51,7 @@ if (const auto temp = MouseInteractions::castRayAndModifyBlockCached(window.wind
 
 
 // двигаем игрока с учётом коллизий
-void Physic::movePlayer(AABB& playerAABB, glm::vec3& velocity, const double dt, bool& onGround, ChunkMap &chunks) {
+void Physic::movePlayer(AABB& playerAABB, glm::vec3& velocity, const double dt, bool& onGround, ChunkMap &chunks, const ChunkGrid &grid) {
     if (std::isnan(velocity.x)) {
         velocity.x = 0;
     }
@@ -94,7 +95,7 @@ void Physic::movePlayer(AABB& playerAABB, glm::vec3& velocity, const double dt,
     for (int x = bx0; x <= bx1; x++) {
         for (int y = by0; y <= by1; y++) {
             for (int z = bz0; z <= bz1; z++) {
-                if (!isSolidBlock(glm::vec3(x,y,z), chunks)) continue;
+                if (!isSolidBlock(glm::vec3(x,y,z), grid, chunks)) continue;
 
                 if (checkCollision(minx,miny,minz,maxx,maxy,maxz,
                                    x,y,z, x+1,y+1,z+1))
@@ -112,7 +113,7 @@ void Physic::movePlayer(AABB& playerAABB, glm::vec3& velocity, const double dt,
     for (int x = bx0; x <= bx1; x++) {
         for (int y = by0; y <= by1; y++) {
             for (int z = bz0; z <= bz1; z++) {
-                if (!isSolidBlock(glm::vec3(x,y,z), chunks)) continue;
+                if (!isSolidBlock(glm::vec3(x,y,z), grid, chunks)) continue;
 
                 if (checkCollision(minx,miny,minz,maxx,maxy,maxz,
                                    x,y,z, x+1,y+1,z+1))
@@ -129,7 +130,7 @@ void Physic::movePlayer(AABB& playerAABB, glm::vec3& velocity, const double dt,
     for (int x = bx0; x <= bx1; x++) {
         for (int y = by0; y <= by1; y++) {
             for (int z = bz0; z <= bz1; z++) {
-                if (!isSolidBlock(glm::vec3(x,y,z), chunks)) continue;
+                if (!isSolidBlock(glm::vec3(x,y,z), grid, chunks)) continue;
 
                 if (checkCollision(minx,miny,minz,maxx,maxy,maxz,
                                    x,y,z, x+1,y+1,z+1))
@@ -0,0 +1,416 @@
+module;
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "../../Definitions/Core/Constants.hpp"
+#include "../../Definitions/Core/Config.h"
+
+import Chunk;
+import ChunkGrid;
+import PaddedVolume;
+import MeshBufferPool;
+import FaceCulling;
+import ChunkLod;
+module ChunkMesher;
+
+
+// === CPU MESHER IMPLEMENTATION ===
+// Упаковка данных в 64 бита
+// [X:5][Y:5][Z:5][Face:3][W:5][H:5][BlockID:8][Unused:28]
+// Больше типов блоков в чанке 7-битный индекс палитры не вместит (PackQuads32)
+constexpr uint32_t QUAD32_PALETTE_MAX = 128;
+
+inline void PushGreedyQuad(std::vector<uint32_t>& data, int x, int y, int z, int face, int w, int h, uint8_t blockId) {
+    uint64_t q = 0;
+    q |= (uint64_t(x) & 31);             // 0..4
+    q |= (uint64_t(y) & 31) << 5;        // 5..9
+    q |= (uint64_t(z) & 31) << 10;       // 10..14
+    q |= (uint64_t(face) & 7) << 15;     // 15..17
+
+    // Width и Height (храним val-1)
+    q |= (uint64_t(w - 1) & 31) << 18;   // 18..22
+    q |= (uint64_t(h - 1) & 31) << 23;   // 23..27
+
+    // BlockID (8 бит)
+    q |= (uint64_t(blockId)) << 28;      // 28..35
+
+    // Осталось 28 бит свободными (36..63)
+
+    data.push_back(static_cast<uint32_t>(q & 0xFFFFFFFF));
+    data.push_back(static_cast<uint32_t>(q >> 32));
+}
+
+// ----------------------------------------------------------------------------
+// 1. Thread Local Storage (Скратчпад)
+// Это самая важная часть. Память выделяется 1 раз на поток и переиспользуется вечно.
+// Никаких malloc/free внутри цикла мешинга!
+// ----------------------------------------------------------------------------
+struct MeshingScratchpad {
+    std::vector<uint32_t> outputBuffer;
+    // 32*32 = 1024 элемента uint16_t (2 КБ), помещается в L1 Cache.
+    // Используем alignas для SIMD оптимизаций компилятора.
+    alignas(64) uint16_t mask[1024];
+
+    // Центр + рамка из 26 соседей (39 КБ, помещается в L1/L2). Живет в TLS, а не на стеке.
+    PaddedVolume volume;
+
+    // --- Битовый мешер (MesherType::Binary) ---
+    // Заполненность 34x34x34 как битовые строки: colX[z*34 + y] - биты по X,
+    // colZ[y*34 + x] - биты по Z. Бит 0 - паддинг (-1), биты 1..32 - чанк, бит 33 - паддинг.
+    alignas(64) uint64_t colX[34 * 34];
+    alignas(64) uint64_t colZ[34 * 34];
+    // Видимые грани среза, разложенные по типам блока: typeRows[слот][u], биты по v
+    alignas(64) uint32_t typeRows[256][32];
+    uint8_t typeSlot[256] = {};  // ID блока -> слот + 1 (0 - тип еще не встречался в срезе)
+    uint8_t usedTypes[256];      // Слот -> ID блока
+
+    MeshingScratchpad() {
+        outputBuffer.reserve(4096); // Резерв сразу с запасом
+    }
+};
+
+static thread_local MeshingScratchpad tls;
+
+// ----------------------------------------------------------------------------
+// 2. Шаблонная функция мешинга плоскости
+// Axis: 0=X, 1=Y, 2=Z.
+// Шаблоны позволяют компилятору сгенерировать 3 разные супер-оптимизированные
+// функции, где все проверки осей вырезаны на этапе компиляции.
+// ----------------------------------------------------------------------------
+// boundaryOnly: центр однородный и сплошной, значит грани могут быть только
+// на внешних слоях чанка (d = 0 для отрицательной нормали, d = 31 для положительной).
+// step: объем прорежен ячейками step^3 (ChunkLod), грани - только на границах ячеек,
+// остальные срезы пустые и пропускаются.
+template <int Axis>
+void MeshPlane(const PaddedVolume& ctx, std::vector<uint32_t>& out, uint16_t* mask, bool boundaryOnly, int step,
+               FaceQuadCounts& faceQuads) {
+    // --- ИСПРАВЛЕНИЕ ТУТ ---
+    // Настраиваем оси так, чтобы V (внутренний цикл) всегда был "горизонтальным"
+    // Axis 0 (X): U=Y, V=Z. (Сканируем Z, потом Y). OK.
+    // Axis 1 (Y): U=Z, V=X. (Сканируем X, потом Z). OK.
+    // Axis 2 (Z): Было U=X, V=Y. СТАЛО U=Y, V=X. (Сканируем X, потом Y). FIX!
+
+    constexpr int U = (Axis == 0) ? 1 : (Axis == 1 ? 2 : 1); // Axis 2 теперь берет 1 (Y)
+    constexpr int V = (Axis == 0) ? 2 : (Axis == 1 ? 0 : 0); // Axis 2 теперь берет 0 (X)
+
+    for (int faceDir = 0; faceDir < 2; ++faceDir) {
+        int faceID;
+        if constexpr (Axis == 0) faceID = (faceDir == 0) ? 5 : 4;
+        else if constexpr (Axis == 1) faceID = (faceDir == 0) ? 3 : 2;
+        else faceID = (faceDir == 0) ? 1 : 0;
+
+        int offset = (faceDir == 0) ? -1 : 1;
+        const size_t faceStart = out.size();
+
+        int dBegin = (faceDir == 0) ? 0 : step - 1, dEnd = 32;
+        if (boundaryOnly) {
+            dBegin = (faceDir == 0) ? 0 : 31;
+            dEnd = dBegin + 1;
+        }
+
+        for (int d = dBegin; d < dEnd; d += step) {
+            int n = 0;
+
+            // --- Pass 1: Заполнение маски ---
+            for (int u = 0; u < 32; ++u) {
+                for (int v = 0; v < 32; ++v) {
+                    int x, y, z;
+                    // --- ИСПРАВЛЕНИЕ КООРДИНАТ ТУТ ---
+                    // Нам нужно правильно собрать x,y,z обратно из d,u,v
+                    if constexpr (Axis == 0)      { x = d; y = u; z = v; }
+                    else if constexpr (Axis == 1) { x = v; y = d; z = u; }
+                    else                          { x = v; y = u; z = d; } // Axis 2: x=v(X), y=u(Y)
+
+                    uint8_t b = ctx.get(x, y, z);
+
+                    int nx = x + (Axis == 0 ? offset : 0);
+                    int ny = y + (Axis == 1 ? offset : 0);
+                    int nz = z + (Axis == 2 ? offset : 0);
+
+                    uint8_t neighbor = ctx.get(nx, ny, nz);
+                    mask[n++] = b * (neighbor == 0);
+                }
+            }
+
+            // --- Pass 2: Greedy Meshing ---
+            n = 0;
+            for (int u = 0; u < 32; ++u) {
+                for (int v = 0; v < 32; ) {
+                    uint16_t type = mask[n + v];
+                    if (type != 0) {
+                        int w = 1;
+                        while (v + w < 32 && mask[n + v + w] == type) w++;
+
+                        int h = 1;
+                        bool done = false;
+                        while (u + h < 32) {
+                            int rowStart = n + (h * 32) + v;
+                            for (int k = 0; k < w; ++k) {
+                                if (mask[rowStart + k] != type) { done = true; break; }
+                            }
+                            if (done) break;
+                            h++;
+                        }
+
+                        // --- ИСПРАВЛЕНИЕ КООРДИНАТ ДЛЯ PUSH ---
+                        int x, y, z;
+                        if constexpr (Axis == 0)      { x=d; y=u; z=v; }
+                        else if constexpr (Axis == 1) { x=v; y=d; z=u; }
+                        else                          { x=v; y=u; z=d; } // Axis 2: x=v(X), y=u(Y)
+
+                        // Важно: w и h теперь соответствуют новым осям.
+                        // Для Axis 2: w - это ширина по X, h - высота по Y.
+                        // PushGreedyQuad должен принимать это корректно.
+                        PushGreedyQuad(out, x, y, z, faceID, w, h, type);
+
+                        for (int l = 0; l < h; ++l) {
+                            int rowOffset = n + v + (l * 32);
+                            for (int k = 0; k < w; ++k) mask[rowOffset + k] = 0;
+                        }
+                        v += w;
+                    } else {
+                        v++;
+                    }
+                }
+                n += 32;
+            }
+        }
+        faceQuads[faceID] = static_cast<uint32_t>((out.size() - faceStart) / 2);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 2b. Битовый мешер
+// Видимость целой строки среза считается одним AND NOT по битовым колонкам,
+// greedy-слияние идет сканированием битов (countr_zero) по маскам каждого типа.
+// Порядок обхода (ось, направление, d, u, v) и прямоугольники те же, что у
+// MeshPlane, поэтому выход совпадает с ним побайтно.
+// ----------------------------------------------------------------------------
+static void BuildOccupancyColumns(const PaddedVolume& ctx, MeshingScratchpad& s) {
+    std::memset(s.colX, 0, sizeof(s.colX));
+    std::memset(s.colZ, 0, sizeof(s.colZ));
+    const uint8_t* data = ctx.data;
+    for (int z = 0; z < 34; ++z) {
+        for (int y = 0; y < 34; ++y) {
+            uint64_t row = 0;
+            for (int x = 0; x < 34; ++x) {
+                const uint64_t solid = data[x + y * 34 + z * 34 * 34] != 0;
+                row |= solid << x;
+                s.colZ[y * 34 + x] |= solid << z;
+            }
+            s.colX[z * 34 + y] = row;
+        }
+    }
+}
+
+template <int Axis>
+void MeshPlaneBinary(const PaddedVolume& ctx, std::vector<uint32_t>& out, MeshingScratchpad& s, bool boundaryOnly,
+                     int step, FaceQuadCounts& faceQuads) {
+    for (int faceDir = 0; faceDir < 2; ++faceDir) {
+        int faceID;
+        if constexpr (Axis == 0) faceID = (faceDir == 0) ? 5 : 4;
+        else if constexpr (Axis == 1) faceID = (faceDir == 0) ? 3 : 2;
+        else faceID = (faceDir == 0) ? 1 : 0;
+
+        const int offset = (faceDir == 0) ? -1 : 1;
+        const size_t faceStart = out.size();
+
+        int dBegin = (faceDir == 0) ? 0 : step - 1, dEnd = 32;
+        if (boundaryOnly) {
+            dBegin = (faceDir == 0) ? 0 : 31;
+            dEnd = dBegin + 1;
+        }
+
+        for (int d = dBegin; d < dEnd; d += step) {
+            int typeCount = 0;
+
+            // --- Pass 1: видимые грани строками + раскладка по типам ---
+            for (int u = 0; u < 32; ++u) {
+                uint64_t solid, neighbor;
+                if constexpr (Axis == 0) {      // x = d, y = u, v = z
+                    solid    = s.colZ[(u + 1) * 34 + (d + 1)];
+                    neighbor = s.colZ[(u + 1) * 34 + (d + 1 + offset)];
+                } else if constexpr (Axis == 1) { // y = d, z = u, v = x
+                    solid    = s.colX[(u + 1) * 34 + (d + 1)];
+                    neighbor = s.colX[(u + 1) * 34 + (d + 1 + offset)];
+                } else {                          // z = d, y = u, v = x
+                    solid    = s.colX[(d + 1) * 34 + (u + 1)];
+                    neighbor = s.colX[(d + 1 + offset) * 34 + (u + 1)];
+                }
+                uint32_t visible = static_cast<uint32_t>((solid & ~neighbor) >> 1);
+
+                while (visible) {
+                    const int v = std::countr_zero(visible);
+                    visible &= visible - 1;
+
+                    uint8_t type;
+                    if constexpr (Axis == 0)      type = ctx.get(d, u, v);
+                    else if constexpr (Axis == 1) type = ctx.get(v, d, u);
+                    else                          type = ctx.get(v, u, d);
+
+                    int slot = s.typeSlot[type];
+                    if (slot == 0) {
+                        s.usedTypes[typeCount] = type;
+                        std::memset(s.typeRows[typeCount], 0, sizeof(s.typeRows[0]));
+                        slot = ++typeCount;
+                        s.typeSlot[type] = static_cast<uint8_t>(slot);
+                    }
+                    s.typeRows[slot - 1][u] |= 1u << v;
+                }
+            }
+
+            // --- Pass 2: greedy по битам ---
+            // В строке u берем самый левый бит среди всех типов - ровно в том
+            // порядке, в котором MeshPlane находит начала прямоугольников.
+            for (int u = 0; u < 32 && typeCount > 0; ++u) {
+                while (true) {
+                    int t = -1, v = 32;
+                    for (int k = 0; k < typeCount; ++k) {
+                        const uint32_t row = s.typeRows[k][u];
+                        if (row && std::countr_zero(row) < v) { v = std::countr_zero(row); t = k; }
+                    }
+                    if (t < 0) break;
+
+                    uint32_t* rows = s.typeRows[t];
+                    const int w = std::countr_zero(~(uint64_t(rows[u]) >> v));
+                    const uint32_t span = static_cast<uint32_t>(((uint64_t(1) << w) - 1) << v);
+
+                    int h = 1;
+                    while (u + h < 32 && (rows[u + h] & span) == span) {
+                        rows[u + h] &= ~span;
+                        h++;
+                    }
+                    rows[u] &= ~span;
+
+                    int x, y, z;
+                    if constexpr (Axis == 0)      { x = d; y = u; z = v; }
+                    else if constexpr (Axis == 1) { x = v; y = d; z = u; }
+                    else                          { x = v; y = u; z = d; }
+
+                    PushGreedyQuad(out, x, y, z, faceID, w, h, s.usedTypes[t]);
+                }
+            }
+
+            for (int k = 0; k < typeCount; ++k) s.typeSlot[s.usedTypes[k]] = 0;
+        }
+        faceQuads[faceID] = static_cast<uint32_t>((out.size() - faceStart) / 2);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 3. Основная функция (Точка входа)
+// ----------------------------------------------------------------------------
+// Однородный сплошной центр, закрытый со всех шести сторон такими же соседями,
+// не может дать ни одной грани.
+static bool IsFullyOccluded(const ChunkNeighborhood& nb) {
+    const glm::ivec3 offs[] = {{-1,0,0},{1,0,0},{0,-1,0},{0,1,0},{0,0,-1},{0,0,1}};
+    for (const auto& o : offs) {
+        const Chunk* c = nb.at(o.x, o.y, o.z);
+        if (!c || !c->isUniform() || c->uniformBlock == BLOCK_AIR) return false;
+    }
+    return true;
+}
+
+void BuildChunkMeshInto(const Chunk* center, const ChunkMap& map, std::vector<uint32_t>& out, const MesherType type,
+                        const ChunkGrid* grid, FaceQuadCounts* faceQuads, const int lod) {
+    // 1. Очищаем выходной буфер (O(1) - просто сброс счетчика, емкость остается)
+    out.clear();
+    FaceQuadCounts localCounts{};
+    FaceQuadCounts& counts = faceQuads ? *faceQuads : localCounts;
+    counts.fill(0);
+
+    // Быстрый путь для однородных чанков: воздух не дает граней вовсе,
+    // сплошной блок - только на границе и только если сосед не закрывает.
+    bool boundaryOnly = false;
+    if (center && center->isUniform() && center->uniformBlock == BLOCK_AIR) return;
+
+    // 2. Соседи: из сетки без блокировок или одним пакетным запросом к карте
+    ChunkNeighborhood neighbors;
+    if (center) fetchNeighborhood(center->worldPosition, map, neighbors, grid);
+
+    if (center && center->isUniform()) {
+        if (IsFullyOccluded(neighbors)) return;
+        boundaryOnly = true;
+    }
+
+    // 3. Копируем центр и рамку в плоский массив (L1/L2)
+    PaddedVolume& ctx = tls.volume;
+    ctx.build(center, neighbors);
+    const int step = lodScale(std::clamp(lod, 0, LOD_MAX));
+    downsampleVolume(ctx, lod, lodReduction);
+
+    // 4. Запускаем шаблоны для каждой оси
+    // Код развернется (inlining) в одну большую простыню инструкций без лишних call
+    if (type == MesherType::Binary) {
+        BuildOccupancyColumns(ctx, tls);
+        MeshPlaneBinary<0>(ctx, out, tls, boundaryOnly, step, counts); // Axis X
+        MeshPlaneBinary<1>(ctx, out, tls, boundaryOnly, step, counts); // Axis Y
+        MeshPlaneBinary<2>(ctx, out, tls, boundaryOnly, step, counts); // Axis Z
+    } else {
+        MeshPlane<0>(ctx, out, tls.mask, boundaryOnly, step, counts); // Axis X
+        MeshPlane<1>(ctx, out, tls.mask, boundaryOnly, step, counts); // Axis Y
+        MeshPlane<2>(ctx, out, tls.mask, boundaryOnly, step, counts); // Axis Z
+    }
+}
+
+uint32_t PackQuads32(std::vector<uint32_t>& quads) {
+    const size_t count = quads.size() / 2;
+    if (count == 0) return 0;
+
+    // Палитра: ID блока -> индекс + 1 (0 - еще не встречался)
+    uint8_t index[256] = {};
+    uint8_t ids[QUAD32_PALETTE_MAX];
+    uint32_t used = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t id = (quads[2 * i] >> 28) | ((quads[2 * i + 1] & 15u) << 4);
+        if (index[id]) continue;
+        if (used == QUAD32_PALETTE_MAX) return 0;
+        ids[used] = static_cast<uint8_t>(id);
+        index[id] = static_cast<uint8_t>(++used);
+    }
+
+    // На месте: квад i пишется в слово i, а читается из 2i и 2i+1 (>= i)
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t low = quads[2 * i];
+        const uint32_t id = (low >> 28) | ((quads[2 * i + 1] & 15u) << 4);
+        quads[i] = (low & 0x7FFFu)                    // X, Y, Z
+                 | (((low >> 18) & 0x3FFu) << 15)     // W-1, H-1
+                 | (uint32_t(index[id] - 1) << 25);   // индекс палитры
+    }
+    quads.resize(count);
+
+    const uint32_t words = (used + 3) / 4;
+    for (uint32_t w = 0; w < words; ++w) {
+        uint32_t word = 0;
+        for (uint32_t b = 0; b < 4 && 4 * w + b < used; ++b) word |= uint32_t(ids[4 * w + b]) << (8 * b);
+        quads.push_back(word);
+    }
+    return words;
+}
+
+MeshHandle BuildChunkMeshPooled(const Chunk* center, const ChunkMap& map, const ChunkGrid* grid, const int lod) {
+    MeshBufferPool& pool = MeshBufferPool::Get();
+    MeshHandle mesh = pool.acquire();
+
+    const size_t capacity = mesh->quads.capacity();
+    BuildChunkMeshInto(center, map, mesh->quads, mesherType, grid, &mesh->faceQuads, lod);
+    if (quadFormat == QuadFormat::Packed32) mesh->paletteWords = PackQuads32(mesh->quads);
+    if (mesh->quads.capacity() != capacity) pool.noteGrowth();
+
+    return mesh;
+}
+
+std::vector<uint32_t> BuildChunkMesh(const Chunk* center, const ChunkMap& map) {
+    return BuildChunkMesh(center, map, mesherType);
+}
+
+std::vector<uint32_t> BuildChunkMesh(const Chunk* center, const ChunkMap& map, const MesherType type) {
+    // Строим в Thread-Local буфер и возвращаем копию
+    // (для сверок и инструментов; игра использует BuildChunkMeshPooled).
+    BuildChunkMeshInto(center, map, tls.outputBuffer, type);
+    return tls.outputBuffer;
+}
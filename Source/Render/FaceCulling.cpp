@@ -0,0 +1,37 @@
+module;
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+module FaceCulling;
+
+uint32_t faceRangeStart(const FaceQuadCounts& counts, const int face) {
+    uint32_t start = 0;
+    for (int f = FACE_COUNT - 1; f > face; --f) start += counts[f];
+    return start;
+}
+
+void packFaceQuads(const FaceQuadCounts& counts, uint32_t packed[3]) {
+    for (int i = 0; i < 3; ++i) {
+        packed[i] = (counts[2 * i] & 0xFFFFu) | ((counts[2 * i + 1] & 0xFFFFu) << 16);
+    }
+}
+
+FaceQuadCounts unpackFaceQuads(const uint32_t packed[3]) {
+    FaceQuadCounts counts{};
+    for (int f = 0; f < FACE_COUNT; ++f) counts[f] = (packed[f / 2] >> (16 * (f & 1))) & 0xFFFFu;
+    return counts;
+}
+
+uint32_t visibleFaceMask(const glm::vec3& relMin, const float size) {
+    // Тот же код, что в shader.comp (visibleFaces)
+    const glm::vec3 relMax = relMin + glm::vec3(size);
+    uint32_t mask = 0;
+    if (relMin.z < 0.0f) mask |= 1u << 0; // +Z
+    if (relMax.z > 0.0f) mask |= 1u << 1; // -Z
+    if (relMin.y < 0.0f) mask |= 1u << 2; // +Y
+    if (relMax.y > 0.0f) mask |= 1u << 3; // -Y
+    if (relMin.x < 0.0f) mask |= 1u << 4; // +X
+    if (relMax.x > 0.0f) mask |= 1u << 5; // -X
+    return mask;
+}
@@ -0,0 +1,71 @@
+module;
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+module MeshBufferPool;
+
+void MeshBufferReturn::operator()(MeshBuffer* buffer) const {
+    MeshBufferPool::Get().release(buffer);
+}
+
+MeshBufferPool& MeshBufferPool::Get() {
+    static MeshBufferPool instance;
+    return instance;
+}
+
+MeshHandle MeshBufferPool::acquire() {
+    acquiredCount.fetch_add(1, std::memory_order_relaxed);
+    liveCount.fetch_add(1, std::memory_order_relaxed);
+
+    MeshBuffer* buffer = nullptr;
+    {
+        std::lock_guard lock(mutex);
+        if (!freeList.empty()) {
+            buffer = freeList.back();
+            freeList.pop_back();
+        }
+    }
+
+    if (!buffer) {
+        createdCount.fetch_add(1, std::memory_order_relaxed);
+        buffer = new MeshBuffer();
+        buffer->quads.reserve(MESH_SLAB_RESERVE);
+    }
+    buffer->quads.clear();
+    buffer->paletteWords = 0;
+    return MeshHandle(buffer);
+}
+
+void MeshBufferPool::release(MeshBuffer* buffer) {
+    if (!buffer) return;
+    liveCount.fetch_sub(1, std::memory_order_relaxed);
+
+    if (buffer->quads.capacity() > MESH_SLAB_MAX_RETAINED) {
+        trimmedCount.fetch_add(1, std::memory_order_relaxed);
+        delete buffer;
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    freeList.push_back(buffer);
+}
+
+MeshPoolStats MeshBufferPool::stats() {
+    MeshPoolStats s;
+    s.acquired = acquiredCount.load(std::memory_order_relaxed);
+    s.slabsCreated = createdCount.load(std::memory_order_relaxed);
+    s.slabGrowths = growthCount.load(std::memory_order_relaxed);
+    s.slabsTrimmed = trimmedCount.load(std::memory_order_relaxed);
+    s.live = liveCount.load(std::memory_order_relaxed);
+    std::lock_guard lock(mutex);
+    s.pooled = freeList.size();
+    return s;
+}
+
+MeshBufferPool::~MeshBufferPool() {
+    for (MeshBuffer* buffer : freeList) delete buffer;
+}
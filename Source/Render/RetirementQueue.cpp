@@ -0,0 +1,55 @@
+module;
+#include <chrono>
+#include <vector>
+
+#include "glad/glad.h"
+module RetirementQueue;
+
+RetirementQueue::RetirementQueue(const int maxFrames) : buckets(maxFrames < 2 ? 2 : maxFrames) {
+    for (Bucket& bucket : buckets) {
+        bucket.slots.reserve(256);
+        bucket.ranges.reserve(256);
+    }
+}
+
+RetirementQueue::~RetirementQueue() {
+    for (const Bucket& bucket : buckets) {
+        if (bucket.fence) glDeleteSync(bucket.fence);
+    }
+}
+
+void RetirementQueue::closeCurrent() {
+    Bucket& bucket = buckets[current];
+    // Пустой кадр fence не требует - корзина остается текущей
+    if (bucket.slots.empty() && bucket.ranges.empty()) return;
+
+    bucket.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    current = (current + 1) % static_cast<int>(buckets.size());
+    ++closed;
+}
+
+bool RetirementQueue::waitOldest(const bool wait) {
+    Bucket& bucket = buckets[oldest];
+
+    GLenum result = glClientWaitSync(bucket.fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        if (!wait) return false;
+        stats.ringFullWaits++;
+        const auto t0 = std::chrono::steady_clock::now();
+        do {
+            result = glClientWaitSync(bucket.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000); // 1 мс
+        } while (result == GL_TIMEOUT_EXPIRED);
+        stats.ringFullWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    // GL_WAIT_FAILED (потерянный контекст) - тоже отпускаем: ждать больше нечего
+
+    glDeleteSync(bucket.fence);
+    bucket.fence = nullptr;
+    return true;
+}
+
+RetirementStats RetirementQueue::getStats() const {
+    RetirementStats s = stats;
+    s.framesPending = static_cast<size_t>(closed);
+    return s;
+}
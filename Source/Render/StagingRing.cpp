@@ -0,0 +1,109 @@
+module;
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "glad/glad.h"
+module StagingRing;
+
+// Выравнивание записей в сегменте (ChunkMetadata и vec4 в шейдерах)
+constexpr size_t STAGING_ALIGN = 16;
+
+StagingRing::StagingRing(const size_t segmentBytes, const int segmentCount)
+    : segmentSize((segmentBytes + STAGING_ALIGN - 1) & ~(STAGING_ALIGN - 1)), segments(segmentCount) {
+    fences.assign(segments, nullptr);
+    copies.reserve(1024);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(segmentSize * segments), nullptr, flags);
+    mapped = static_cast<uint8_t*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(segmentSize * segments), flags));
+
+    if (!mapped) {
+        std::cerr << "StagingRing: persistent mapping failed, falling back to glNamedBufferSubData" << std::endl;
+    }
+}
+
+StagingRing::~StagingRing() {
+    for (GLsync fence : fences) {
+        if (fence) glDeleteSync(fence);
+    }
+    if (mapped) glUnmapNamedBuffer(buffer);
+    if (buffer) glDeleteBuffers(1, &buffer);
+}
+
+void* StagingRing::reserve(const GLuint dst, const GLintptr dstOffset, const size_t bytes) {
+    if (!mapped || bytes == 0) return nullptr;
+
+    const size_t aligned = (bytes + STAGING_ALIGN - 1) & ~(STAGING_ALIGN - 1);
+    if (cursor + aligned > segmentSize) {
+        stats.overflows++;
+        return nullptr;
+    }
+
+    const size_t srcOffset = static_cast<size_t>(current) * segmentSize + cursor;
+    cursor += aligned;
+
+    // Склейка с предыдущей копией: тот же буфер, вплотную и в источнике, и в приемнике
+    if (!copies.empty()) {
+        PendingCopy& last = copies.back();
+        if (last.dst == dst &&
+            last.srcOffset + last.size == static_cast<GLintptr>(srcOffset) &&
+            last.dstOffset + last.size == dstOffset) {
+            last.size += static_cast<GLsizeiptr>(bytes);
+            stats.bytesStaged += bytes;
+            stats.stageCalls++;
+            return mapped + srcOffset;
+        }
+    }
+
+    copies.push_back({dst, static_cast<GLintptr>(srcOffset), dstOffset, static_cast<GLsizeiptr>(bytes)});
+    stats.bytesStaged += bytes;
+    stats.stageCalls++;
+    return mapped + srcOffset;
+}
+
+bool StagingRing::stage(const GLuint dst, const GLintptr dstOffset, const void* src, const size_t bytes) {
+    void* ptr = reserve(dst, dstOffset, bytes);
+    if (!ptr) return false;
+    std::memcpy(ptr, src, bytes);
+    return true;
+}
+
+void StagingRing::flush() {
+    if (copies.empty()) return;
+
+    for (const PendingCopy& c : copies) {
+        glCopyNamedBufferSubData(buffer, c.dst, c.srcOffset, c.dstOffset, c.size);
+    }
+    stats.copyCalls += copies.size();
+    copies.clear();
+
+    // Закрываем сегмент: CPU вернется к нему только после этого fence
+    fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    current = (current + 1) % segments;
+    cursor = 0;
+    waitSegment(current);
+}
+
+void StagingRing::waitSegment(const int segment) {
+    GLsync fence = fences[segment];
+    if (!fence) return;
+
+    // Обычно GPU давно прошел этот fence (он поставлен segments-1 flush'ей назад)
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        stats.fenceWaits++;
+        auto t0 = std::chrono::steady_clock::now();
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000); // 1 мс
+        } while (result == GL_TIMEOUT_EXPIRED);
+        stats.fenceWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    glDeleteSync(fence);
+    fences[segment] = nullptr;
+}
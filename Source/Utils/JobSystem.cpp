@@ -0,0 +1,396 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+module JobSystem;
+
+namespace {
+    thread_local int tlsWorkerIndex = -1;
+
+    // Сколько раз обойти соседей перед сном (задачи часто приходят пачками)
+    constexpr int STEAL_ROUNDS_BEFORE_SLEEP = 4;
+
+    // Поворот взгляда больше ~15 градусов устаревает ключи
+    constexpr float VIEW_REKEY_COS = 0.966f;
+
+    // Копия вида у каждого воркера, обновляется при смене эпохи
+    thread_local JobView tlsView;
+    thread_local uint32_t tlsViewEpoch = 0;
+
+    // Выбор жертвы для кражи (xorshift: воркеры не ломятся к одному соседу разом)
+    thread_local uint32_t tlsVictimRng = 0x9e3779b9u;
+
+    uint32_t nextVictimSeed() {
+        uint32_t x = tlsVictimRng;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return tlsVictimRng = x;
+    }
+
+    void pinCurrentThread(uint32_t index) {
+#if defined(__linux__)
+        const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cores, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)index; // На других платформах привязка не поддерживается
+#endif
+    }
+}
+
+int priorityBucket(const JobView& view, JobClass cls, const glm::ivec3& chunk) {
+    const glm::ivec3 d = chunk - view.center;
+    // Отмена - по квадрату XZ, как зона загрузки поисковика (круг срезал бы ее углы)
+    const float cancel = view.cancelRadius[static_cast<size_t>(cls)];
+    if (cancel > 0.0f && static_cast<float>(std::max(std::abs(d.x), std::abs(d.z))) > cancel) return BUCKET_CANCELLED;
+
+    const float dist = std::sqrt(static_cast<float>(d.x * d.x + d.y * d.y + d.z * d.z));
+    if (dist == 0.0f) return 0;
+
+    // facing: 1 - прямо по взгляду, -1 - за спиной
+    const float facing = glm::dot(glm::vec3(d), view.forward) / dist;
+    const float key = dist * (facing < 0.0f ? 1.0f - BEHIND_PENALTY * facing : 1.0f);
+    return std::min(PRIORITY_BUCKETS - 1, static_cast<int>(key * BUCKETS_PER_CHUNK));
+}
+
+JobSystem& JobSystem::Get() {
+    static JobSystem instance;
+    return instance;
+}
+
+int JobSystem::currentWorker() { return tlsWorkerIndex; }
+
+void JobSystem::start(uint32_t workerCount, bool pinToCores) {
+    if (!threads.empty()) return;
+
+    if (workerCount == 0) {
+        // Главный поток и поисковик живут вне пула
+        const uint32_t cores = std::thread::hardware_concurrency();
+        workerCount = cores > 3 ? cores - 2 : 1;
+    }
+
+    stopping = false;
+    workers.clear();
+    for (uint32_t i = 0; i < workerCount; ++i) workers.push_back(std::make_unique<Worker>());
+    statsEpoch = std::chrono::steady_clock::now();
+
+    threads.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i, pinToCores);
+    }
+}
+
+void JobSystem::stop() {
+    if (threads.empty()) return;
+    {
+        std::lock_guard lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCV.notify_all();
+    for (auto& t : threads) if (t.joinable()) t.join();
+    threads.clear();
+}
+
+JobSystem::~JobSystem() { stop(); }
+
+// Маски и счетчики пишутся только под мьютексом воркера: load + store, без RMW
+void JobSystem::pushLocked(Worker& w, size_t cls, int bucket, Entry&& entry) {
+    w.classes[cls].buckets[bucket].items.push_back(std::move(entry));
+    w.masks[cls].store(w.masks[cls].load(std::memory_order_relaxed) | (1ull << bucket), std::memory_order_relaxed);
+    w.queued[cls].store(w.queued[cls].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+JobSystem::Entry JobSystem::popLocked(Worker& w, size_t cls, int bucket) {
+    Bucket& b = w.classes[cls].buckets[bucket];
+    Entry e = std::move(b.items[b.head++]);
+    if (b.head == b.items.size()) {
+        b.items.clear(); // Емкость остается
+        b.head = 0;
+        w.masks[cls].store(w.masks[cls].load(std::memory_order_relaxed) & ~(1ull << bucket), std::memory_order_relaxed);
+    }
+    w.queued[cls].store(w.queued[cls].load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    return e;
+}
+
+bool JobSystem::hasQueued() const {
+    for (const auto& w : workers) {
+        for (const auto& mask : w->masks) {
+            if (mask.load(std::memory_order_relaxed) != 0) return true;
+        }
+    }
+    return false;
+}
+
+const JobView& JobSystem::currentView(uint32_t& epoch) const {
+    epoch = viewEpoch.load(std::memory_order_acquire);
+    if (tlsViewEpoch != epoch) {
+        std::lock_guard lock(viewMutex);
+        tlsView = view;
+        tlsViewEpoch = epoch = viewEpoch.load(std::memory_order_relaxed);
+    }
+    return tlsView;
+}
+
+void JobSystem::push(uint32_t worker, JobClass cls, Entry&& entry) {
+    const auto c = static_cast<size_t>(cls);
+    int bucket = 0;
+    if (entry.keyed) {
+        uint32_t epoch;
+        const JobView& v = currentView(epoch);
+        entry.epoch = epoch;
+        // Вне радиуса уже сейчас - в конец; отменит (или нет) пересчет при извлечении:
+        // поисковик мог увидеть новую позицию игрока раньше, чем главный поток обновил вид
+        bucket = priorityBucket(v, cls, entry.chunk);
+        if (bucket == BUCKET_CANCELLED) bucket = PRIORITY_BUCKETS - 1;
+    }
+
+    unfinished.fetch_add(1, std::memory_order_relaxed);
+    {
+        Worker& w = *workers[worker];
+        std::lock_guard lock(w.mutex);
+        pushLocked(w, c, bucket, std::move(entry));
+    }
+    wakeOne();
+}
+
+void JobSystem::wakeOne() {
+    // Маска выставлена до забора; пара seq_cst-заборов (здесь и в предикате сна):
+    // спящий либо увидит задачу в маске, либо мы увидим его в sleepers, возьмем
+    // мьютекс после его входа в wait и разбудим его
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard lock(sleepMutex);
+        sleepCV.notify_one();
+    }
+}
+
+void JobSystem::submit(JobClass cls, Job job) {
+    Entry entry;
+    entry.run = std::move(job);
+    if (workers.empty()) {
+        entry.run(); // Пул не запущен (например, в утилитах) - выполняем на месте
+        return;
+    }
+    // Из воркера - в свою очередь (горячий кэш, без конкуренции), иначе - по кругу
+    const int self = tlsWorkerIndex;
+    const uint32_t target = self >= 0
+        ? static_cast<uint32_t>(self)
+        : nextWorker.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(workers.size());
+    push(target, cls, std::move(entry));
+}
+
+void JobSystem::submit(JobClass cls, const glm::ivec3& chunk, Job job, Job onCancel) {
+    if (workers.empty()) {
+        job();
+        return;
+    }
+    Entry entry;
+    entry.run = std::move(job);
+    entry.onCancel = std::move(onCancel);
+    entry.chunk = chunk;
+    entry.keyed = true;
+
+    const int self = tlsWorkerIndex;
+    const uint32_t target = self >= 0
+        ? static_cast<uint32_t>(self)
+        : nextWorker.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(workers.size());
+    push(target, cls, std::move(entry));
+}
+
+void JobSystem::setView(const glm::ivec3& center, const glm::vec3& forward) {
+    std::lock_guard lock(viewMutex);
+    const bool moved = center != view.center;
+    const bool turned = glm::dot(forward, view.forward) < VIEW_REKEY_COS;
+    if (!moved && !turned) return;
+    view.center = center;
+    view.forward = forward;
+    viewEpoch.fetch_add(1, std::memory_order_release);
+}
+
+void JobSystem::setCancelRadius(JobClass cls, float radiusChunks) {
+    std::lock_guard lock(viewMutex);
+    view.cancelRadius[static_cast<size_t>(cls)] = radiusChunks;
+    viewEpoch.fetch_add(1, std::memory_order_release);
+}
+
+int64_t JobSystem::pending(JobClass cls) const {
+    int64_t total = 0;
+    for (const auto& w : workers) total += w->queued[static_cast<size_t>(cls)].load(std::memory_order_relaxed);
+    return total;
+}
+
+bool JobSystem::tryPop(uint32_t self, Job& out, bool& stolen) {
+    const uint32_t n = static_cast<uint32_t>(workers.size());
+    uint32_t epoch;
+    const JobView& v = currentView(epoch);
+
+    for (size_t c = 0; c < JOB_CLASS_COUNT; ++c) {
+        // 1. Своя очередь: своя самая срочная корзина, даже если у соседа есть
+        // срочнее - раздача по кругу держит очереди близкими по ключам
+        if (popFrom(self, c, v, epoch, out)) {
+            stolen = false;
+            return true;
+        }
+
+        // 2. Своя пуста - кража у соседей, начиная со случайного
+        const uint32_t start = nextVictimSeed() % n;
+        for (uint32_t k = 0; k < n; ++k) {
+            const uint32_t victim = (start + k) % n;
+            if (victim == self) continue;
+            if (workers[victim]->masks[c].load(std::memory_order_relaxed) == 0) continue;
+            if (popFrom(victim, c, v, epoch, out)) {
+                stolen = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool JobSystem::popFrom(uint32_t worker, size_t c, const JobView& v, uint32_t epoch, Job& out) {
+    Worker& w = *workers[worker];
+    const auto cls = static_cast<JobClass>(c);
+
+    while (w.masks[c].load(std::memory_order_relaxed) != 0) {
+        Job cancel;
+        {
+            std::lock_guard lock(w.mutex);
+            const uint64_t mask = w.masks[c].load(std::memory_order_relaxed);
+            if (mask == 0) return false; // Забрали между чтением маски и блокировкой
+            const int bucket = std::countr_zero(mask);
+            Entry e = popLocked(w, c, bucket);
+
+            if (e.keyed && e.epoch != epoch) {
+                rekeyedCount.fetch_add(1, std::memory_order_relaxed);
+                int newBucket = priorityBucket(v, cls, e.chunk);
+                if (newBucket == BUCKET_CANCELLED && e.onCancel) {
+                    cancel = std::move(e.onCancel);
+                } else {
+                    if (newBucket == BUCKET_CANCELLED) newBucket = PRIORITY_BUCKETS - 1;
+                    e.epoch = epoch;
+                    if (newBucket > bucket) {
+                        // Игрок ушел от чанка: в дальнюю корзину, берем следующую
+                        demotedCount.fetch_add(1, std::memory_order_relaxed);
+                        pushLocked(w, c, newBucket, std::move(e));
+                        continue;
+                    }
+                }
+            }
+
+            if (!cancel) {
+                out = std::move(e.run);
+                return true;
+            }
+        }
+
+        // Отмена - вне блокировки очереди (колбэк может трогать чужие структуры)
+        cancelledCount.fetch_add(1, std::memory_order_relaxed);
+        cancel();
+        unfinished.fetch_sub(1, std::memory_order_release);
+    }
+    return false;
+}
+
+void JobSystem::workerLoop(uint32_t index, bool pin) {
+    tlsWorkerIndex = static_cast<int>(index);
+    tlsVictimRng = 0x9e3779b9u ^ ((index + 1) * 0x85ebca6bu); // Свой порядок кражи у каждого воркера
+    if (pin) pinCurrentThread(index);
+    Worker& me = *workers[index];
+
+    Job job;
+    int idleRounds = 0;
+    while (true) {
+        bool stolen = false;
+        if (tryPop(index, job, stolen)) {
+            idleRounds = 0;
+            const auto t0 = std::chrono::steady_clock::now();
+            job();
+            job = nullptr; // Захваченные shared_ptr отпускаем сразу, а не при следующей задаче
+            const auto t1 = std::chrono::steady_clock::now();
+
+            me.busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(),
+                                std::memory_order_relaxed);
+            me.jobsRun.fetch_add(1, std::memory_order_relaxed);
+            if (stolen) me.jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            unfinished.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        if (++idleRounds < STEAL_ROUNDS_BEFORE_SLEEP) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock lock(sleepMutex);
+        if (stopping && !hasQueued()) return;
+        sleepers.fetch_add(1);
+        me.sleeps.fetch_add(1, std::memory_order_relaxed);
+        sleepCV.wait(lock, [this] {
+            std::atomic_thread_fence(std::memory_order_seq_cst); // Пара к забору в wakeOne
+            return stopping || hasQueued();
+        });
+        sleepers.fetch_sub(1);
+        idleRounds = 0;
+    }
+}
+
+void JobSystem::waitIdle() {
+    while (unfinished.load(std::memory_order_acquire) > 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+std::vector<WorkerStats> JobSystem::stats() const {
+    const double wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - statsEpoch).count();
+    std::vector<WorkerStats> out;
+    out.reserve(workers.size());
+    for (const auto& w : workers) {
+        WorkerStats s;
+        s.jobsRun = w->jobsRun.load(std::memory_order_relaxed);
+        s.jobsStolen = w->jobsStolen.load(std::memory_order_relaxed);
+        s.sleeps = w->sleeps.load(std::memory_order_relaxed);
+        s.busyUs = static_cast<double>(w->busyNs.load(std::memory_order_relaxed)) * 1e-3;
+        s.wallUs = wallUs;
+        s.utilisation = wallUs > 0.0 ? std::min(1.0, s.busyUs / wallUs) : 0.0;
+        out.push_back(s);
+    }
+    return out;
+}
+
+JobQueueStats JobSystem::queueStats() const {
+    JobQueueStats s;
+    s.rekeyed = rekeyedCount.load(std::memory_order_relaxed);
+    s.demoted = demotedCount.load(std::memory_order_relaxed);
+    s.cancelled = cancelledCount.load(std::memory_order_relaxed);
+    s.epoch = viewEpoch.load(std::memory_order_relaxed);
+    return s;
+}
+
+void JobSystem::resetStats() {
+    for (auto& w : workers) {
+        w->jobsRun.store(0, std::memory_order_relaxed);
+        w->jobsStolen.store(0, std::memory_order_relaxed);
+        w->sleeps.store(0, std::memory_order_relaxed);
+        w->busyNs.store(0, std::memory_order_relaxed);
+    }
+    statsEpoch = std::chrono::steady_clock::now();
+}
@@ -2,20 +2,214 @@ module;
 #include <vector>
 #include <cstdint>
 #include <algorithm>
-#include <condition_variable>
-#include <functional>
-#include <queue>
-#include <thread>
+#include <bit>
+#include <iterator>
+#include <unordered_map>
 module VramAllocator;
 
+// ==========================================
+// 1. TLSF
+// ==========================================
+
+// Класс размера: fl - степень двойки (0 - размеры меньше SL_COUNT), sl - доля внутри нее
+void VRamAllocator::mapping(const uint32_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < SL_COUNT) {
+        fl = 0;
+        sl = size;
+        return;
+    }
+    const uint32_t f = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    sl = (size >> (f - SL_LOG2)) - SL_COUNT;
+    fl = f - SL_LOG2 + 1;
+}
+
+VRamAllocator::VRamAllocator(const uint32_t size) : totalCapacity(size) {
+    for (auto& row : freeHeads) std::fill(std::begin(row), std::end(row), NIL);
+    nodes.reserve(4096);
+    usedByOffset.reserve(4096);
+    freeByOffset.reserve(4096);
+
+    const uint32_t root = newNode();
+    nodes[root].offset = 0;
+    nodes[root].size = size;
+    insertFree(root);
+}
+
+uint32_t VRamAllocator::newNode() {
+    if (!spareNodes.empty()) {
+        const uint32_t index = spareNodes.back();
+        spareNodes.pop_back();
+        nodes[index] = Node{};
+        return index;
+    }
+    nodes.emplace_back();
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void VRamAllocator::insertFree(const uint32_t index) {
+    uint32_t fl, sl;
+    mapping(nodes[index].size, fl, sl);
+
+    Node& node = nodes[index];
+    node.isFree = true;
+    node.prevFree = NIL;
+    node.nextFree = freeHeads[fl][sl];
+    if (node.nextFree != NIL) nodes[node.nextFree].prevFree = index;
+    freeHeads[fl][sl] = index;
+
+    slBitmap[fl] |= 1u << sl;
+    flBitmap |= 1u << fl;
+    freeByOffset[node.offset] = index;
+    ++freeBlockCount;
+}
+
+void VRamAllocator::removeFree(const uint32_t index) {
+    uint32_t fl, sl;
+    mapping(nodes[index].size, fl, sl);
+
+    Node& node = nodes[index];
+    if (node.prevFree != NIL) nodes[node.prevFree].nextFree = node.nextFree;
+    if (node.nextFree != NIL) nodes[node.nextFree].prevFree = node.prevFree;
+    if (freeHeads[fl][sl] == index) {
+        freeHeads[fl][sl] = node.nextFree;
+        if (node.nextFree == NIL) {
+            slBitmap[fl] &= ~(1u << sl);
+            if (slBitmap[fl] == 0) flBitmap &= ~(1u << fl);
+        }
+    }
+    node.isFree = false;
+    node.prevFree = node.nextFree = NIL;
+    freeByOffset.erase(node.offset);
+    --freeBlockCount;
+}
+
+void VRamAllocator::absorbNext(const uint32_t index) {
+    const uint32_t next = nodes[index].nextPhys;
+    nodes[index].size += nodes[next].size;
+    nodes[index].nextPhys = nodes[next].nextPhys;
+    if (nodes[index].nextPhys != NIL) nodes[nodes[index].nextPhys].prevPhys = index;
+    spareNodes.push_back(next);
+}
+
+uint32_t VRamAllocator::allocate(const uint32_t size) {
+    if (size == 0) return 0;
+
+    // Округляем запрос вверх до границы класса: тогда подходит ЛЮБОЙ блок
+    // найденного класса, и первый в списке берется без проверки
+    uint32_t search = size;
+    if (size >= SL_COUNT) {
+        const uint32_t f = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        const uint32_t round = (1u << (f - SL_LOG2)) - 1;
+        if (size > UINT32_MAX - round) return VRAM_ALLOC_FAILED;
+        search += round;
+    }
+
+    uint32_t fl, sl;
+    mapping(search, fl, sl);
+    if (fl >= FL_COUNT) return VRAM_ALLOC_FAILED;
+
+    uint32_t slMap = slBitmap[fl] & (~0u << sl);
+    if (slMap == 0) {
+        const uint32_t flMap = fl + 1 < 32 ? flBitmap & (~0u << (fl + 1)) : 0;
+        if (flMap == 0) return VRAM_ALLOC_FAILED; // Память кончилась (или раздроблена)
+        fl = static_cast<uint32_t>(std::countr_zero(flMap));
+        slMap = slBitmap[fl];
+    }
+    sl = static_cast<uint32_t>(std::countr_zero(slMap));
+
+    const uint32_t index = freeHeads[fl][sl];
+    removeFree(index);
+    return takeBlock(index, size);
+}
+
+bool VRamAllocator::allocateAt(const uint32_t offset, const uint32_t size) {
+    if (size == 0) return false;
+    const auto it = freeByOffset.find(offset);
+    if (it == freeByOffset.end()) return false;
+    const uint32_t index = it->second;
+    if (nodes[index].size < size) return false;
+    removeFree(index);
+    takeBlock(index, size);
+    return true;
+}
+
+uint32_t VRamAllocator::takeBlock(const uint32_t index, const uint32_t size) {
+    // Хвост - обратно в свободные
+    if (nodes[index].size - size >= MIN_SPLIT) {
+        const uint32_t rest = newNode(); // Может переаллоцировать nodes - дальше только индексы
+        nodes[rest].offset = nodes[index].offset + size;
+        nodes[rest].size = nodes[index].size - size;
+        nodes[rest].prevPhys = index;
+        nodes[rest].nextPhys = nodes[index].nextPhys;
+        if (nodes[rest].nextPhys != NIL) nodes[nodes[rest].nextPhys].prevPhys = rest;
+        nodes[index].nextPhys = rest;
+        nodes[index].size = size;
+        insertFree(rest);
+    }
 
-     VRamAllocator::VRamAllocator(uint32_t size) : totalCapacity(size) {
+    usedMemory += nodes[index].size;
+    usedByOffset.emplace(nodes[index].offset, index);
+    return nodes[index].offset;
+}
+
+void VRamAllocator::free(const uint32_t offset, const uint32_t size) {
+    if (size == 0) return;
+    const auto it = usedByOffset.find(offset);
+    if (it == usedByOffset.end()) return; // Чужой или уже освобожденный блок
+    uint32_t index = it->second;
+    usedByOffset.erase(it);
+    // Блок мог быть выдан чуть больше запроса (хвост < MIN_SPLIT) - считаем по узлу
+    usedMemory -= nodes[index].size;
+
+    const uint32_t next = nodes[index].nextPhys;
+    if (next != NIL && nodes[next].isFree) {
+        removeFree(next);
+        absorbNext(index);
+    }
+    const uint32_t prev = nodes[index].prevPhys;
+    if (prev != NIL && nodes[prev].isFree) {
+        removeFree(prev);
+        absorbNext(prev);
+        index = prev;
+    }
+    insertFree(index);
+}
+
+float VRamAllocator::getUsage() const { return static_cast<float>(usedMemory) / totalCapacity; }
+size_t VRamAllocator::getFreeBlockCount() const { return freeBlockCount; }
+
+VRamStats VRamAllocator::stats() const {
+    VRamStats s;
+    s.capacity = totalCapacity;
+    s.used = usedMemory;
+    s.freeTotal = totalCapacity - usedMemory;
+    s.freeBlocks = freeBlockCount;
+
+    // Самый большой блок - в старшем непустом классе; внутри класса размеры
+    // различаются, поэтому проходим его список
+    if (flBitmap != 0) {
+        const uint32_t fl = 31 - static_cast<uint32_t>(std::countl_zero(flBitmap));
+        const uint32_t sl = 31 - static_cast<uint32_t>(std::countl_zero(slBitmap[fl]));
+        for (uint32_t i = freeHeads[fl][sl]; i != NIL; i = nodes[i].nextFree) {
+            s.largestFree = std::max(s.largestFree, nodes[i].size);
+        }
+    }
+    if (s.freeTotal > 0) s.externalFragmentation = 1.0f - static_cast<float>(s.largestFree) / static_cast<float>(s.freeTotal);
+    return s;
+}
+
+// ==========================================
+// 2. First fit
+// ==========================================
+
+
+     FirstFitVRamAllocator::FirstFitVRamAllocator(uint32_t size) : totalCapacity(size) {
         freeBlocks.reserve(1024); // Пре-аллокация, чтобы избежать ресайзов
         freeBlocks.push_back({0, size});
     }
 
     // Аллокация (Best Fit или First Fit)
-    uint32_t VRamAllocator::allocate(uint32_t size) {
+    uint32_t FirstFitVRamAllocator::allocate(uint32_t size) {
         if (size == 0) return 0;
 
         // Выравнивание размера до 4 байт (опционально, но полезно для GPU)
@@ -45,10 +239,10 @@ module VramAllocator;
         }
 
         // Память кончилась
-        return 0xFFFFFFFF; // UINT32_MAX
+        return VRAM_ALLOC_FAILED;
     }
 
-    void VRamAllocator::free(uint32_t offset, uint32_t size) {
+    void FirstFitVRamAllocator::free(uint32_t offset, uint32_t size) {
         if (size == 0) return;
         // size = (size + 3) & ~3;
         usedMemory -= size;
@@ -81,43 +275,16 @@ module VramAllocator;
     }
 
     // Дебаг инфо
-    float VRamAllocator::getUsage() const { return static_cast<float>(usedMemory) / totalCapacity; }
-    size_t VRamAllocator::getFreeBlockCount() const { return freeBlocks.size(); }
-
-// ==========================================
-// 2. Priority Thread Pool
-// ==========================================
+    float FirstFitVRamAllocator::getUsage() const { return static_cast<float>(usedMemory) / totalCapacity; }
+    size_t FirstFitVRamAllocator::getFreeBlockCount() const { return freeBlocks.size(); }
 
-
-
-    PriorityThreadPool::PriorityThreadPool(size_t threads) {
-        for(size_t i = 0; i < threads; ++i) {
-            workers.emplace_back([this] {
-                while(true) {
-                    Task task;
-                    {
-                        std::unique_lock<std::mutex> lock(queueMutex);
-                        condition.wait(lock, [this] { return stop || !tasks.empty(); });
-                        if(stop && tasks.empty()) return;
-                        task = std::move(tasks.top());
-                        tasks.pop();
-                    }
-                    task.func();
-                }
-            });
-        }
-    }
-
-    PriorityThreadPool::~PriorityThreadPool() {
-        stop = true;
-        condition.notify_all();
-        for(auto& worker : workers) if(worker.joinable()) worker.join();
-    }
-
-    void PriorityThreadPool::enqueue(int priority, std::function<void()> f) {
-        {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            tasks.push({priority, std::move(f)});
-        }
-        condition.notify_one();
+    VRamStats FirstFitVRamAllocator::stats() const {
+        VRamStats s;
+        s.capacity = totalCapacity;
+        s.used = usedMemory;
+        s.freeTotal = totalCapacity - usedMemory;
+        s.freeBlocks = freeBlocks.size();
+        for (const auto& b : freeBlocks) s.largestFree = std::max(s.largestFree, b.size);
+        if (s.freeTotal > 0) s.externalFragmentation = 1.0f - static_cast<float>(s.largestFree) / static_cast<float>(s.freeTotal);
+        return s;
     }
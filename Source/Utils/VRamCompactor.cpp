@@ -0,0 +1,103 @@
+module;
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <vector>
+
+import VramAllocator;
+module VRamCompactor;
+
+// Сколько мешей просмотреть за один plan, даже если переносить нечего:
+// проход по пулу размазан по кадрам, а не делается целиком
+constexpr int SCAN_PER_CALL = 512;
+
+void VRamCompactor::track(const uint32_t offset, const uint32_t size, const uint32_t owner) {
+    if (size == 0) return;
+    live[offset] = {size, owner};
+}
+
+void VRamCompactor::untrack(const uint32_t offset) {
+    live.erase(offset);
+}
+
+uint32_t VRamCompactor::plan(VRamAllocator& allocator, const uint32_t budget, std::vector<VRamMove>& out) {
+    uint32_t moved = 0;
+    if (budget == 0 || live.empty()) return 0;
+
+    // Самый маленький из верхних кандидатов: дыры меньше него пропускаем сразу
+    auto smallestOnTop = [this] {
+        uint32_t smallest = UINT32_MAX;
+        int looked = 0;
+        for (auto top = live.rbegin(); top != live.rend() && looked < CANDIDATES_PER_GAP; ++top, ++looked) {
+            smallest = std::min(smallest, top->second.size);
+        }
+        return smallest;
+    };
+    uint32_t minCandidate = smallestOnTop();
+
+    auto it = live.lower_bound(cursor);
+    for (int scanned = 0; moved < budget && scanned < SCAN_PER_CALL; ++scanned) {
+        if (it == live.end()) {
+            ++counters.passes;
+            cursor = 0;
+            return moved;
+        }
+
+        // Дыра под мешем it: от конца предыдущего меша до него. Размеры у GpuManager
+        // кратны 4 (как и MIN_SPLIT аллокатора), поэтому конец учтенного меша
+        // совпадает с концом блока в аллокаторе.
+        const uint32_t gapEnd = it->first;
+        uint32_t gapStart = 0;
+        if (it != live.begin()) {
+            const auto prev = std::prev(it);
+            gapStart = prev->first + prev->second.size;
+        }
+
+        bool selfMoved = false;
+        while (gapStart < gapEnd && gapEnd - gapStart >= minCandidate && moved < budget) {
+            // Кандидат - самый верхний меш выше дыры, который в нее влезает
+            const uint32_t gapSize = gapEnd - gapStart;
+            auto candidate = live.end();
+            int looked = 0;
+            for (auto top = live.rbegin(); top != live.rend() && looked < CANDIDATES_PER_GAP; ++top, ++looked) {
+                if (top->first < gapEnd) break;
+                if (top->second.size <= gapSize) {
+                    candidate = std::next(top).base();
+                    break;
+                }
+            }
+            if (candidate == live.end()) break;
+
+            // Начало дыры может быть занято зомби - ждем, пока его освободят
+            const Live mesh = candidate->second;
+            if (!allocator.allocateAt(gapStart, mesh.size)) {
+                ++counters.blockedGaps;
+                break;
+            }
+
+            out.push_back({mesh.owner, candidate->first, gapStart, mesh.size});
+            selfMoved |= candidate == it;
+            live.erase(candidate);
+            live.emplace(gapStart, mesh);
+            gapStart += mesh.size;
+            moved += mesh.size;
+            ++counters.moves;
+            counters.movedUnits += mesh.size;
+            minCandidate = smallestOnTop();
+        }
+
+        // Меш it мог сам уехать в свою дыру (итератор невалиден) - тогда ищем следующий заново
+        if (selfMoved) it = live.upper_bound(gapEnd);
+        else ++it;
+    }
+
+    cursor = it == live.end() ? 0 : it->first;
+    return moved;
+}
+
+VRamCompactorStats VRamCompactor::stats() const {
+    VRamCompactorStats s = counters;
+    s.tracked = live.size();
+    return s;
+}
@@ -0,0 +1,1127 @@
+#if defined(__linux__)
+#include <mimalloc-new-delete.h>
+#endif
+
+// Headless бенчмарк пайплайна чанков: генерация -> мешинг -> упаковка.
+// Не создает окно и GL-контекст, поэтому запускается на CI без GPU.
+// Регион фиксирован и сидирован, так что цифры сравнимы между машинами.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Definitions/Core/Config.h"
+#include "Definitions/Core/Constants.hpp"
+#include "BenchVerify.hpp"
+
+import Chunk;
+import ChunkGrid;
+import ChunkGenerationSystem;
+import ChunkMesher;
+import MeshBufferPool;
+import MeshReadiness;
+import VramAllocator;
+import VRamCompactor;
+import FaceCulling;
+import ChunkLod;
+import JobSystem;
+import TerrainKernels;
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    int radiusXZ = 8;  // 17 чанков по X и Z
+    int yMin = -9;     // 18 чанков по Y
+    int yMax = 8;
+    int seed = 1773;
+    int repeat = 1;
+    bool verify = false; // Сверки (BenchVerify.cpp и проверки внутри замеров) + микробенчмарк ядер
+    bool palette = false; // Генерировать чанки в палитровом режиме (paletteStorage)
+    MesherType mesher = MesherType::Binary;
+    QuadFormat quads = QuadFormat::Packed32;
+    int lodStart = 4;    // lodStartDistance
+    int jobs = 0;        // >0: прогон gen+mesh через JobSystem на 1, 2, 4 ... jobs воркерах
+    bool pin = false;    // Привязать воркеров JobSystem к ядрам
+};
+
+struct StageStats {
+    const char* name;
+    std::vector<double> latencyUs; // Время на один чанк
+    double totalSeconds = 0.0;
+    uint64_t outputBytes = 0;
+    uint64_t quads = 0;
+};
+
+static double elapsedUs(BenchClock::time_point from, BenchClock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return values[idx];
+}
+
+static void printStage(const StageStats& s) {
+    double chunksPerSec = s.totalSeconds > 0 ? static_cast<double>(s.latencyUs.size()) / s.totalSeconds : 0.0;
+    double quadsPerSec = s.totalSeconds > 0 ? static_cast<double>(s.quads) / s.totalSeconds : 0.0;
+
+    std::cout << std::left << std::setw(6) << s.name << std::right << std::fixed << std::setprecision(1)
+              << " chunks/s=" << std::setw(10) << chunksPerSec
+              << " quads/s=" << std::setw(12) << quadsPerSec
+              << " p50=" << std::setw(8) << percentile(s.latencyUs, 0.50) << "us"
+              << " p99=" << std::setw(8) << percentile(s.latencyUs, 0.99) << "us"
+              << " bytes=" << s.outputBytes << "\n";
+}
+
+static bool parseArg(const std::string& arg, const char* name, int& out) {
+    std::string prefix = std::string(name) + "=";
+    if (arg.rfind(prefix, 0) != 0) return false;
+    out = std::atoi(arg.c_str() + prefix.size());
+    return true;
+}
+
+static BenchConfig parseConfig(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (parseArg(arg, "--radius", cfg.radiusXZ)) continue;
+        if (parseArg(arg, "--ymin", cfg.yMin)) continue;
+        if (parseArg(arg, "--ymax", cfg.yMax)) continue;
+        if (parseArg(arg, "--seed", cfg.seed)) continue;
+        if (parseArg(arg, "--repeat", cfg.repeat)) continue;
+        if (arg == "--verify") { cfg.verify = true; continue; }
+        if (arg == "--palette") { cfg.palette = true; continue; }
+        if (arg == "--mesher=scalar") { cfg.mesher = MesherType::Scalar; continue; }
+        if (arg == "--mesher=binary") { cfg.mesher = MesherType::Binary; continue; }
+        if (arg == "--quads=64") { cfg.quads = QuadFormat::Wide64; continue; }
+        if (arg == "--quads=32") { cfg.quads = QuadFormat::Packed32; continue; }
+        if (parseArg(arg, "--lodstart", cfg.lodStart)) continue;
+        if (parseArg(arg, "--jobs", cfg.jobs)) continue;
+        if (arg == "--pin") { cfg.pin = true; continue; }
+        std::cerr << "Unknown argument: " << arg << "\n"
+                  << "Usage: cubeBench [--radius=8] [--ymin=-9] [--ymax=8] [--seed=1773] [--repeat=1] [--verify] [--palette] [--mesher=scalar|binary] [--quads=32|64] [--lodstart=4] [--jobs=N] [--pin]\n";
+        std::exit(2);
+    }
+    cfg.repeat = std::max(1, cfg.repeat);
+    return cfg;
+}
+
+// Время одного вызова ядра в микросекундах (среднее по iterations вызовам)
+template <typename F>
+static double timeKernelUs(int iterations, F&& kernel) {
+    auto t0 = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) kernel();
+    return elapsedUs(t0, BenchClock::now()) / iterations;
+}
+
+// Скалярные ядра генерации против SIMD: мкс на вызов. Правильность - в verifyUpscale/verifyClassify.
+// Для замера берем слой у поверхности, где встречаются все четыре типа блоков.
+static void benchKernels() {
+    std::vector<float> lowRes(NOISE_LR_SIZE), highRes(NOISE_HR_SIZE), upscaled(NOISE_HR_SIZE);
+    std::vector<uint8_t> blocks(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z);
+    generateLowResNoise(glm::ivec3(0, 0, 0), lowRes.data());
+    upscaleNoiseScalar(lowRes.data(), highRes.data());
+
+    double scalarUs = timeKernelUs(2000, [&] { upscaleNoiseScalar(lowRes.data(), upscaled.data()); });
+    double simdUs = timeKernelUs(2000, [&] { upscaleNoise(lowRes.data(), upscaled.data()); });
+    std::cout << std::fixed << std::setprecision(2)
+              << "upscale  scalar=" << scalarUs << "us simd=" << simdUs << "us speedup="
+              << (simdUs > 0 ? scalarUs / simdUs : 0.0) << "x\n";
+
+    scalarUs = timeKernelUs(2000, [&] { classifyBlocksScalar(highRes.data(), 0, SEA_LEVEL, blocks.data()); });
+    simdUs = timeKernelUs(2000, [&] { classifyBlocks(highRes.data(), 0, SEA_LEVEL, blocks.data()); });
+    std::cout << "classify scalar=" << scalarUs << "us simd(" << classifyBlocksArch() << ")=" << simdUs << "us speedup="
+              << (simdUs > 0 ? scalarUs / simdUs : 0.0) << "x\n";
+}
+
+// Скалярный мешер против битового на чанках региона: мкс на чанк (совпадение - в verifyMesher).
+static void benchMesherEngines(const std::vector<std::shared_ptr<Chunk>>& generated, const ChunkMap& map) {
+    if (generated.empty()) return;
+    double scalarUs = 0.0, binaryUs = 0.0;
+    for (const auto& chunk : generated) {
+        auto t0 = BenchClock::now();
+        auto reference = BuildChunkMesh(chunk.get(), map, MesherType::Scalar);
+        auto t1 = BenchClock::now();
+        auto binary = BuildChunkMesh(chunk.get(), map, MesherType::Binary);
+        auto t2 = BenchClock::now();
+        scalarUs += elapsedUs(t0, t1);
+        binaryUs += elapsedUs(t1, t2);
+    }
+    const double n = static_cast<double>(generated.size());
+    std::cout << std::fixed << std::setprecision(2)
+              << "mesher   scalar=" << scalarUs / n << "us binary=" << binaryUs / n << "us speedup="
+              << (binaryUs > 0 ? scalarUs / binaryUs : 0.0) << "x\n";
+}
+
+// Генерация дальних LOD прямо из сетки шума против полной: мкс на чанк для
+// каждого LOD генерации (чанки над рельефом не берем - там генерации нет).
+// Под verify: узлы сеток с шагом 2 и 4 совпадают с узлами lowResNoise, а в углах
+// ячеек прореженный чанк сплошной там же, где полный.
+static bool benchCoarseGeneration(const std::vector<glm::ivec3>& region, bool verify) {
+    std::vector<glm::ivec3> sample;
+    for (const auto& pos : region) {
+        if (pos.y * CHUNK_SIZE_Y <= MAX_TERRAIN_HEIGHT) sample.push_back(pos);
+    }
+    if (sample.size() > 1024) {
+        const size_t stride = sample.size() / 1024;
+        for (size_t i = 0; i < 1024; ++i) sample[i] = sample[i * stride];
+        sample.resize(1024);
+    }
+    if (sample.empty()) return true;
+
+    double us[GENERATION_LOD_MAX + 1] = {};
+    uint64_t uniform = 0; // Чтобы результат генерации не выбросил оптимизатор
+    for (int lod = 0; lod <= GENERATION_LOD_MAX; ++lod) {
+        const auto t0 = BenchClock::now();
+        for (const auto& pos : sample) uniform += generateChunkData(pos, lod)->isUniform();
+        us[lod] = elapsedUs(t0, BenchClock::now()) / static_cast<double>(sample.size());
+    }
+
+    float maxDiff = 0.0f;
+    uint64_t corners = 0, solidMismatches = 0;
+    if (verify) {
+        std::vector<float> lowRes(NOISE_LR_SIZE), coarse(coarseNoiseSize(2));
+        for (size_t i = 0; i < std::min<size_t>(sample.size(), 128); ++i) {
+            const glm::ivec3 pos = sample[i];
+            generateLowResNoise(pos, lowRes.data());
+            const auto full = generateChunkData(pos, 0);
+            for (int lod = 1; lod <= GENERATION_LOD_MAX; ++lod) {
+                const int step = lodScale(lod), n = CHUNK_SIZE_X / step, g = step / 2;
+                generateCoarseNoise(pos, step, coarse.data());
+                for (int z = 0; z < n; ++z)
+                    for (int y = 0; y <= n; ++y)
+                        for (int x = 0; x < n; ++x) {
+                            const float a = coarse[x + y * n + z * n * (n + 1)];
+                            const float b = lowRes[x * g + y * g * NOISE_LR_XZ + z * g * NOISE_LR_XZ * NOISE_LR_Y];
+                            maxDiff = std::max(maxDiff, std::abs(a - b));
+                        }
+
+                const auto reduced = generateChunkData(pos, lod);
+                for (int z = 0; z < CHUNK_SIZE_Z; z += step)
+                    for (int y = 0; y < CHUNK_SIZE_Y; y += step)
+                        for (int x = 0; x < CHUNK_SIZE_X; x += step) {
+                            corners++;
+                            solidMismatches += (full->get(x, y, z) != BLOCK_AIR) != (reduced->get(x, y, z) != BLOCK_AIR);
+                        }
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "coarse gen (" << sample.size() << " chunks, " << uniform
+              << " uniform)";
+    for (int lod = 0; lod <= GENERATION_LOD_MAX; ++lod) {
+        std::cout << " " << lodScale(lod) << "x=" << us[lod] << "us";
+        if (lod > 0) std::cout << " (" << (us[lod] > 0 ? us[0] / us[lod] : 0.0) << "x faster)";
+    }
+    if (verify) std::cout << std::setprecision(7) << " max noise diff=" << maxDiff
+                          << " corner solidity mismatches=" << solidMismatches << "/" << corners;
+    std::cout << "\n";
+    // Узлы совпадают с точностью до округления FastNoise: у самого порога может
+    // перевернуться единичный угол, но не больше
+    return maxDiff <= 1e-5f && solidMismatches * 1000 <= corners;
+}
+
+// Стопки чанков одной задачей (generateColumnData) против генерации по чанку:
+// мкс на чанк. Под verify стопка должна побитово совпасть с эталоном, который
+// раскрашивает шум каждого чанка скалярно сверху вниз, неся остаток земли, и
+// одиночный чанк (generateChunkData) - тоже; отдельно печатается, сколько блоков
+// земли перешло через границы чанков (против раскраски без остатка).
+static bool benchColumnGeneration(const BenchConfig& cfg, bool verify) {
+    const int count = cfg.yMax - cfg.yMin + 1;
+    if (count <= 0 || count > 64) return true;
+    const uint64_t mask = count == 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+
+    std::vector<glm::ivec3> bottoms;
+    for (int x = -cfg.radiusXZ; x <= cfg.radiusXZ; ++x)
+        for (int z = -cfg.radiusXZ; z <= cfg.radiusXZ; ++z) bottoms.emplace_back(x, cfg.yMin, z);
+    if (bottoms.size() > 64) {
+        const size_t stride = bottoms.size() / 64;
+        for (size_t i = 0; i < 64; ++i) bottoms[i] = bottoms[i * stride];
+        bottoms.resize(64);
+    }
+
+    uint64_t uniform = 0;
+    auto t0 = BenchClock::now();
+    for (const auto& bottom : bottoms)
+        for (int i = 0; i < count; ++i) uniform += generateChunkData(bottom + glm::ivec3(0, i, 0))->isUniform();
+    const double chunkUs = elapsedUs(t0, BenchClock::now()) / static_cast<double>(bottoms.size() * count);
+
+    std::vector<std::shared_ptr<Chunk>> column;
+    t0 = BenchClock::now();
+    for (const auto& bottom : bottoms) {
+        generateColumnData(bottom, count, mask, nullptr, column);
+        for (const auto& chunk : column) uniform += chunk->isUniform();
+    }
+    const double columnUs = elapsedUs(t0, BenchClock::now()) / static_cast<double>(bottoms.size() * count);
+
+    uint64_t mismatches = 0, carriedDirt = 0;
+    if (verify) {
+        std::vector<float> lowRes(NOISE_LR_SIZE), highRes(NOISE_HR_SIZE);
+        std::vector<uint8_t> reference(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z);
+        std::vector<uint8_t> noCarry(reference.size());
+        std::vector<uint8_t> dirtDepth(CHUNK_SIZE_X * CHUNK_SIZE_Z);
+        for (size_t c = 0; c < std::min<size_t>(bottoms.size(), 16); ++c) {
+            const glm::ivec3 bottom = bottoms[c];
+            generateColumnData(bottom, count, mask, nullptr, column);
+            std::map<int, std::shared_ptr<Chunk>> byY;
+            for (const auto& chunk : column) byY[chunk->worldPosition.y] = chunk;
+
+            // Эталон начинает с чанка над стопкой, как и generateColumnData
+            std::fill(dirtDepth.begin(), dirtDepth.end(), 0);
+            for (int y = bottom.y + count; y >= bottom.y; --y) {
+                const glm::ivec3 pos(bottom.x, y, bottom.z);
+                if (y * CHUNK_SIZE_Y > MAX_TERRAIN_HEIGHT) {
+                    if (y < bottom.y + count && !byY[y]->isUniform()) mismatches++;
+                    continue;
+                }
+                generateLowResNoise(pos, lowRes.data());
+                upscaleNoiseScalar(lowRes.data(), highRes.data());
+                classifyBlocksScalar(highRes.data(), y * CHUNK_SIZE_Y, SEA_LEVEL, reference.data(), dirtDepth.data());
+                if (y == bottom.y + count) continue;
+
+                const auto& chunk = byY[y];
+                const auto single = generateChunkData(pos);
+                classifyBlocksScalar(highRes.data(), y * CHUNK_SIZE_Y, SEA_LEVEL, noCarry.data());
+                for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+                    for (int yy = 0; yy < CHUNK_SIZE_Y; ++yy)
+                        for (int x = 0; x < CHUNK_SIZE_X; ++x) {
+                            const int i = x + yy * CHUNK_SIZE_X + z * CHUNK_SIZE_X * CHUNK_SIZE_Y;
+                            const uint8_t expected = reference[i];
+                            mismatches += chunk->get(x, yy, z) != expected;
+                            mismatches += single->get(x, yy, z) != expected;
+                            carriedDirt += expected == BLOCK_DIRT && noCarry[i] != BLOCK_DIRT;
+                        }
+            }
+        }
+
+        // Смешанные LOD (кольца идут и по Y): полные чанки под прореженными
+        // получают остаток земли так же, как при генерации по одному
+        uint8_t lods[64];
+        for (int i = 0; i < count; ++i) lods[i] = static_cast<uint8_t>(i % 2);
+        for (size_t c = 0; c < std::min<size_t>(bottoms.size(), 4); ++c) {
+            generateColumnData(bottoms[c], count, mask, lods, column);
+            for (const auto& chunk : column) {
+                if (chunk->genLod != 0 || chunk->isUniform()) continue;
+                const auto single = generateChunkData(chunk->worldPosition);
+                for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+                    for (int yy = 0; yy < CHUNK_SIZE_Y; ++yy)
+                        for (int x = 0; x < CHUNK_SIZE_X; ++x) mismatches += chunk->get(x, yy, z) != single->get(x, yy, z);
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "column gen (" << bottoms.size() << " columns x " << count
+              << ", " << uniform << " uniform) per-chunk=" << chunkUs << "us column=" << columnUs << "us ("
+              << (columnUs > 0 ? chunkUs / columnUs : 0.0) << "x)";
+    if (verify) std::cout << " mismatches=" << mismatches << " dirt carried across seams=" << carriedDirt;
+    std::cout << "\n";
+    return mismatches == 0;
+}
+
+// Память блоков региона в трех режимах: сырой буфер у каждого чанка, плоский
+// с однородными чанками без буфера и палитровый. Чанки, сгенерированные без
+// палитры, сжимаются во временную копию. При verify сверяет распаковку с оригиналом.
+static bool reportMemory(const std::vector<std::shared_ptr<Chunk>>& chunks, bool verify) {
+    constexpr size_t VOLUME = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
+    size_t rawBytes = 0, flatBytes = 0, paletteBytes = 0;
+    uint64_t mismatches = 0, wide = 0;
+    uint8_t a[CHUNK_SIZE_X], b[CHUNK_SIZE_X];
+
+    for (const auto& chunk : chunks) {
+        rawBytes += VOLUME;
+        flatBytes += chunk->isUniform() ? 0 : VOLUME;
+        if (!chunk->data()) {
+            paletteBytes += chunk->memoryBytes();
+            continue;
+        }
+
+        Chunk copy(chunk->worldPosition);
+        std::memcpy(copy.data(), chunk->data(), VOLUME);
+        // Больше 16 видов блоков - палитры нет (8-битных индексов нет), чанк остается плоским
+        wide += !copy.compress();
+        paletteBytes += copy.memoryBytes();
+
+        if (!verify) continue;
+        for (int z = 0; z < CHUNK_SIZE_Z; ++z)
+            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+                chunk->copyRow(y, z, a);
+                copy.copyRow(y, z, b);
+                mismatches += std::memcmp(a, b, sizeof(a)) != 0;
+            }
+    }
+
+    auto mib = [](size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    std::cout << std::fixed << std::setprecision(2)
+              << "memory   raw=" << mib(rawBytes) << "MiB flat=" << mib(flatBytes) << "MiB palette="
+              << mib(paletteBytes) << "MiB density=" << (paletteBytes ? static_cast<double>(flatBytes) / paletteBytes : 0.0)
+              << "x (vs raw " << (paletteBytes ? static_cast<double>(rawBytes) / paletteBytes : 0.0)
+              << "x, flat >16 kinds=" << wide << ")";
+    if (verify) std::cout << " row mismatches=" << mismatches;
+    std::cout << "\n";
+    return mismatches == 0;
+}
+
+// Отсечение направлений граней (FaceCulling, то же решение, что в shader.comp).
+// Доля квадов, которые остаются в командах, для камеры в центре региона.
+// Под verify: диапазоны направлений в мешах сходятся с faceID квадов, упаковка
+// в ChunkMetadata обратима, а маска никогда не отбрасывает грань, которая на
+// самом деле смотрит на камеру (перебор всех плоскостей чанка).
+static bool benchFaceCulling(const BenchConfig& cfg, const std::vector<std::shared_ptr<Chunk>>& generated,
+                             const ChunkMap& map, bool verify) {
+    const glm::vec3 camera(16.5f, (cfg.yMin + cfg.yMax) * 0.5f * 32.0f + 16.25f, 16.5f);
+    std::vector<uint32_t> quads;
+    FaceQuadCounts counts{};
+    uint64_t totalQuads = 0, keptQuads = 0, badRanges = 0, badPacks = 0, missed = 0;
+
+    for (const auto& chunk : generated) {
+        BuildChunkMeshInto(chunk.get(), map, quads, mesherType, nullptr, &counts);
+        const glm::vec3 relMin = glm::vec3(chunk->worldPosition) * 32.0f - camera;
+        const uint32_t mask = visibleFaceMask(relMin);
+        for (int f = 0; f < FACE_COUNT; ++f) {
+            totalQuads += counts[f];
+            if (mask & (1u << f)) keptQuads += counts[f];
+        }
+        if (!verify) continue;
+
+        uint32_t packed[3];
+        packFaceQuads(counts, packed);
+        badPacks += unpackFaceQuads(packed) != counts;
+
+        uint32_t sum = 0;
+        for (int f = 0; f < FACE_COUNT; ++f) {
+            const uint32_t start = faceRangeStart(counts, f);
+            for (uint32_t q = start; q < start + counts[f] && 2 * q < quads.size(); ++q) {
+                badRanges += ((quads[2 * q] >> 15) & 7u) != static_cast<uint32_t>(f);
+            }
+            sum += counts[f];
+        }
+        badRanges += sum * 2 != quads.size();
+    }
+
+    if (verify) {
+        // Грань +X воксела x лежит в плоскости min + x + 1 и видна, если камера правее;
+        // -X - в плоскости min + x, видна, если левее. Так же по Y и Z.
+        std::mt19937 rng(2024);
+        std::uniform_real_distribution<float> coord(-80.0f, 80.0f);
+        for (int n = 0; n < 100000; ++n) {
+            glm::vec3 relMin(coord(rng), coord(rng), coord(rng));
+            if (n % 2) relMin = glm::vec3(std::floor(relMin.x), std::floor(relMin.y), std::floor(relMin.z)); // Камера ровно в плоскости граней
+            const uint32_t mask = visibleFaceMask(relMin);
+            for (int axis = 0; axis < 3; ++axis) {
+                const int plusFace = 4 - 2 * axis, minusFace = plusFace + 1; // X: 4/5, Y: 2/3, Z: 0/1
+                bool plusSeen = false, minusSeen = false;
+                for (int v = 0; v < 32; ++v) {
+                    plusSeen |= relMin[axis] + static_cast<float>(v + 1) < 0.0f;
+                    minusSeen |= relMin[axis] + static_cast<float>(v) > 0.0f;
+                }
+                missed += plusSeen && !(mask & (1u << plusFace));
+                missed += minusSeen && !(mask & (1u << minusFace));
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "facecull kept " << (totalQuads ? 100.0 * keptQuads / totalQuads : 0.0) << "% of " << totalQuads << " quads";
+    if (verify) std::cout << " bad ranges=" << badRanges << " bad packs=" << badPacks << " missed faces=" << missed;
+    std::cout << "\n";
+    return badRanges == 0 && badPacks == 0 && missed == 0;
+}
+
+// Packed32 против Wide64 на мешах региона: байт на квад (с палитрой и выравниванием,
+// как в пуле вершин) и чанки, оставшиеся в Wide64 из-за палитры больше 128 типов.
+// Под verify каждый 32-битный квад раскладывается обратно и сверяется с 64-битным;
+// грань берется по диапазону направления, как в shader.vert.
+static bool benchQuadFormat(const std::vector<std::shared_ptr<Chunk>>& generated, const ChunkMap& map, bool verify) {
+    std::vector<uint32_t> wide, packed;
+    FaceQuadCounts counts{};
+    uint64_t quads = 0, wideBytes = 0, packedBytes = 0, fallbacks = 0, mismatches = 0;
+
+    for (const auto& chunk : generated) {
+        BuildChunkMeshInto(chunk.get(), map, wide, mesherType, nullptr, &counts);
+        if (wide.empty()) continue;
+        packed = wide;
+        const uint32_t paletteWords = PackQuads32(packed);
+        const auto count = static_cast<uint32_t>(wide.size() / 2);
+        quads += count;
+        wideBytes += ((wide.size() + 3) & ~size_t(3)) * sizeof(uint32_t);
+        if (paletteWords == 0) {
+            ++fallbacks;
+            packedBytes += ((wide.size() + 3) & ~size_t(3)) * sizeof(uint32_t);
+            continue;
+        }
+        packedBytes += ((packed.size() + 3) & ~size_t(3)) * sizeof(uint32_t);
+        if (!verify) continue;
+
+        mismatches += packed.size() != count + paletteWords;
+        for (int f = 0; f < FACE_COUNT; ++f) {
+            const uint32_t start = faceRangeStart(counts, f);
+            for (uint32_t q = start; q < start + counts[f] && q < count; ++q) {
+                const uint32_t low = wide[2 * q], high = wide[2 * q + 1];
+                const uint32_t word = packed[q];
+                const uint32_t pal = word >> 25;
+                const size_t palWord = count + pal / 4;
+                const uint32_t blockId = palWord < packed.size() ? (packed[palWord] >> (8 * (pal % 4))) & 0xFFu : 256u;
+                const uint32_t expected = (low & 0x7FFFu) | (((low >> 18) & 0x3FFu) << 15);
+                mismatches += (word & 0x1FFFFFFu) != expected
+                           || blockId != ((low >> 28) | ((high & 15u) << 4))
+                           || ((low >> 15) & 7u) != static_cast<uint32_t>(f);
+            }
+        }
+    }
+
+    const double wideB = quads ? static_cast<double>(wideBytes) / quads : 0.0;
+    const double packedB = quads ? static_cast<double>(packedBytes) / quads : 0.0;
+    std::cout << std::fixed << std::setprecision(2)
+              << "quads64 " << wideB << " B/quad, quads32 " << packedB << " B/quad ("
+              << (wideBytes ? 100.0 * packedBytes / wideBytes : 0.0) << "%), wide fallbacks=" << fallbacks;
+    if (verify) std::cout << " mismatches=" << mismatches;
+    std::cout << "\n";
+    return mismatches == 0;
+}
+
+// Квады дальних LOD: весь регион каждым LOD и по политике колец (игрок в чанке
+// (0, середина, 0)). Бюджет - полное разрешение в пределах renderDistanceXZ:
+// столько квадов игра рисует без LOD. Под verify: квады LOD k кратны ячейке
+// (начало, размеры, срез грани), скалярный и битовый мешеры совпадают на
+// прореженном объеме, гистерезис не возвращает LOD при шаге на кольцо назад.
+static bool benchLod(const BenchConfig& cfg, const std::vector<std::shared_ptr<Chunk>>& generated,
+                     const ChunkMap& map, bool verify) {
+    const glm::ivec3 center(0, (cfg.yMin + cfg.yMax) / 2, 0);
+    const MesherType other = mesherType == MesherType::Binary ? MesherType::Scalar : MesherType::Binary;
+    std::vector<uint32_t> quads, check;
+    uint64_t perLod[LOD_MAX + 1] = {}, chunksPerLod[LOD_MAX + 1] = {};
+    double meshUs[LOD_MAX + 1] = {};
+    uint64_t policy = 0, budget = 0, misaligned = 0, mismatched = 0, flips = 0;
+
+    for (const auto& chunk : generated) {
+        const glm::ivec3 pos = chunk->worldPosition;
+        const int policyLod = selectLod(chunkRing(pos, center), 0);
+        const bool inBudget = std::max(std::abs(pos.x - center.x), std::abs(pos.z - center.z)) <= renderDistanceXZ;
+        chunksPerLod[policyLod]++;
+
+        for (int lod = 0; lod <= LOD_MAX; ++lod) {
+            const auto t0 = BenchClock::now();
+            BuildChunkMeshInto(chunk.get(), map, quads, mesherType, nullptr, nullptr, lod);
+            meshUs[lod] += elapsedUs(t0, BenchClock::now());
+
+            const uint64_t count = quads.size() / 2;
+            perLod[lod] += count;
+            if (lod == policyLod) policy += count;
+            if (lod == 0 && inBudget) budget += count;
+            if (!verify || lod == 0) continue;
+
+            // Грань с положительной нормалью (четный faceID) лежит на последнем срезе ячейки
+            const uint32_t cell = lodScale(lod);
+            for (size_t q = 0; q < count; ++q) {
+                const uint32_t low = quads[2 * q];
+                const uint32_t coord[3] = {low & 31u, (low >> 5) & 31u, (low >> 10) & 31u};
+                const uint32_t face = (low >> 15) & 7u, normalAxis = 2 - face / 2;
+                const uint32_t w = ((low >> 18) & 31u) + 1, h = ((low >> 23) & 31u) + 1;
+                bool ok = w % cell == 0 && h % cell == 0;
+                for (uint32_t a = 0; a < 3; ++a) {
+                    const uint32_t expected = (a == normalAxis && (face & 1u) == 0) ? cell - 1 : 0;
+                    ok &= coord[a] % cell == expected;
+                }
+                misaligned += !ok;
+            }
+            if (lod == 2) {
+                BuildChunkMeshInto(chunk.get(), map, check, other, nullptr, nullptr, lod);
+                mismatched += check != quads;
+            }
+        }
+    }
+
+    if (verify) {
+        for (int ring = 0; ring < 128; ++ring)
+            for (int current = 0; current <= LOD_MAX; ++current)
+                for (const int dir : {-1, 1}) {
+                    if (ring + dir < 0) continue;
+                    const int a = selectLod(ring, current);
+                    const int b = selectLod(ring + dir, a);
+                    flips += b != a && selectLod(ring, b) != b;
+                }
+    }
+
+    const size_t n = std::max<size_t>(1, generated.size());
+    std::cout << std::fixed << std::setprecision(1) << "lod quads";
+    for (int lod = 0; lod <= LOD_MAX; ++lod) {
+        std::cout << " " << lodScale(lod) << "x=" << perLod[lod] << " ("
+                  << (perLod[0] ? 100.0 * perLod[lod] / perLod[0] : 0.0) << "%, " << meshUs[lod] / n << "us)";
+    }
+    std::cout << "\nlod policy (start ring " << lodStartDistance << ") chunks";
+    for (int lod = 0; lod <= LOD_MAX; ++lod) std::cout << " " << lodScale(lod) << "x=" << chunksPerLod[lod];
+    std::cout << " quads=" << policy << " vs full res within radius " << renderDistanceXZ << "=" << budget
+              << " (" << (budget ? 100.0 * policy / budget : 0.0) << "%)";
+    if (verify) std::cout << " misaligned=" << misaligned << " mesher mismatches=" << mismatched << " flips=" << flips;
+    std::cout << "\n";
+    return misaligned == 0 && mismatched == 0 && flips == 0;
+}
+
+// ChunkGrid против ChunkMap: случайные точечные запросы (как у физики и поисковика)
+// и мешинг всего региона с соседями из сетки. Меши обязаны совпасть.
+static bool benchChunkGrid(const BenchConfig& cfg, const std::vector<std::shared_ptr<Chunk>>& generated, const ChunkMap& map) {
+    ChunkGrid grid(cfg.radiusXZ, std::max(std::abs(cfg.yMin), std::abs(cfg.yMax)));
+    grid.setCenter(glm::ivec3(0, (cfg.yMin + cfg.yMax) / 2, 0));
+    for (const auto& chunk : generated) grid.publish(chunk);
+
+    // Точечные запросы: половина попадает в загруженные чанки, половина - мимо
+    constexpr int LOOKUPS = 1 << 20;
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> dxz(-cfg.radiusXZ - 2, cfg.radiusXZ + 2);
+    std::uniform_int_distribution<int> dy(cfg.yMin - 2, cfg.yMax + 2);
+    std::vector<glm::ivec3> queries(LOOKUPS);
+    for (auto& q : queries) q = glm::ivec3(dxz(rng), dy(rng), dxz(rng));
+
+    uint64_t mapHits = 0, gridHits = 0;
+    auto t0 = BenchClock::now();
+    for (const auto& q : queries) mapHits += map.tryGet(q) != nullptr;
+    auto t1 = BenchClock::now();
+    for (const auto& q : queries) gridHits += grid.contains(q, map);
+    auto t2 = BenchClock::now();
+
+    // Мешинг: соседи из карты (пакетный запрос) против соседей из сетки
+    std::vector<uint32_t> viaMap, viaGrid;
+    uint64_t mismatches = 0;
+    double mapMeshUs = 0.0, gridMeshUs = 0.0;
+    for (const auto& chunk : generated) {
+        auto m0 = BenchClock::now();
+        BuildChunkMeshInto(chunk.get(), map, viaMap, mesherType);
+        auto m1 = BenchClock::now();
+        BuildChunkMeshInto(chunk.get(), map, viaGrid, mesherType, &grid);
+        auto m2 = BenchClock::now();
+        mapMeshUs += elapsedUs(m0, m1);
+        gridMeshUs += elapsedUs(m1, m2);
+        mismatches += viaMap != viaGrid;
+    }
+
+    const double mapNs = elapsedUs(t0, t1) * 1000.0 / LOOKUPS;
+    const double gridNs = elapsedUs(t1, t2) * 1000.0 / LOOKUPS;
+    std::cout << std::fixed << std::setprecision(2)
+              << "lookup   map=" << mapNs << "ns grid=" << gridNs << "ns speedup=" << (gridNs > 0 ? mapNs / gridNs : 0.0)
+              << "x hits=" << mapHits << "/" << gridHits << "\n"
+              << "meshnb   map=" << mapMeshUs / generated.size() << "us grid=" << gridMeshUs / generated.size()
+              << "us mismatches=" << mismatches << "\n";
+    return mismatches == 0 && mapHits == gridHits;
+}
+
+// --- Трасса аллокаций вершинного буфера ---
+// Стриминг как в игре: резидентное окно из VRAM_TRACE_RESIDENT чанков, новые
+// приходят, самые старые (с разбросом) уходят, часть резидентных перемешивается
+// с чуть другим размером. Размеры - настоящие меши региона (выровненные, как в
+// GpuManager). Одна трасса проигрывается на обоих аллокаторах.
+constexpr size_t VRAM_TRACE_RESIDENT = 20000;
+constexpr size_t VRAM_TRACE_OPS = 400000;
+
+struct VRamTraceOp {
+    bool alloc;
+    uint32_t id;
+    uint32_t size;
+};
+
+static std::vector<VRamTraceOp> buildVRamTrace(const std::vector<uint32_t>& meshSizes, uint32_t& peakLive) {
+    std::vector<VRamTraceOp> trace;
+    trace.reserve(VRAM_TRACE_OPS);
+    std::mt19937 rng(4242);
+    std::deque<std::pair<uint32_t, uint32_t>> resident; // (id, size), старые - в начале
+    uint32_t nextId = 0;
+    uint64_t live = 0, peak = 0;
+
+    while (trace.size() < VRAM_TRACE_OPS) {
+        const uint32_t roll = rng() % 100;
+        if (roll < 20 && !resident.empty()) {
+            // Перемешивание: освобождаем и берем заново чуть другого размера
+            auto& [id, size] = resident[rng() % resident.size()];
+            trace.push_back({false, id, size});
+            live -= size;
+            const uint32_t jitter = size / 10 + 4;
+            size = std::max<uint32_t>(4, (size - jitter / 2 + rng() % jitter) & ~3u);
+            trace.push_back({true, id, size});
+            live += size;
+        } else {
+            const uint32_t size = meshSizes[rng() % meshSizes.size()];
+            resident.emplace_back(nextId, size);
+            trace.push_back({true, nextId++, size});
+            live += size;
+            while (resident.size() > VRAM_TRACE_RESIDENT) {
+                // Уходит один из самых старых (игрок движется не строго по прямой)
+                const size_t victim = rng() % std::max<size_t>(1, resident.size() / 8);
+                std::swap(resident[victim], resident.front());
+                trace.push_back({false, resident.front().first, resident.front().second});
+                live -= resident.front().second;
+                resident.pop_front();
+            }
+        }
+        peak = std::max(peak, live);
+    }
+    peakLive = static_cast<uint32_t>(peak);
+    return trace;
+}
+
+template <typename Allocator>
+static bool replayVRamTrace(const char* name, const std::vector<VRamTraceOp>& trace, uint32_t capacity, bool checkOverlap) {
+    Allocator allocator(capacity);
+    std::vector<uint32_t> offsets(trace.size(), VRAM_ALLOC_FAILED); // id -> offset (id < числа операций)
+    std::map<uint32_t, uint32_t> liveRanges; // Только для checkOverlap
+    uint64_t failures = 0;
+    size_t peakFreeBlocks = 0;
+    float worstFragmentation = 0.0f;
+    bool ok = true;
+
+    const auto t0 = BenchClock::now();
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const VRamTraceOp& op = trace[i];
+        if (op.alloc) {
+            const uint32_t offset = allocator.allocate(op.size);
+            offsets[op.id] = offset;
+            if (offset == VRAM_ALLOC_FAILED) { ++failures; continue; }
+            if (checkOverlap) {
+                auto next = liveRanges.lower_bound(offset);
+                if (next != liveRanges.end() && next->first < offset + op.size) ok = false;
+                if (next != liveRanges.begin() && std::prev(next)->first + std::prev(next)->second > offset) ok = false;
+                if (offset + op.size > capacity) ok = false;
+                liveRanges[offset] = op.size;
+            }
+        } else if (offsets[op.id] != VRAM_ALLOC_FAILED) {
+            allocator.free(offsets[op.id], op.size);
+            if (checkOverlap) liveRanges.erase(offsets[op.id]);
+            offsets[op.id] = VRAM_ALLOC_FAILED;
+        }
+        // Раздробленность - выборочно, чтобы не мерить stats() вместо аллокатора
+        if ((i & 4095) == 0) {
+            const VRamStats st = allocator.stats();
+            peakFreeBlocks = std::max(peakFreeBlocks, st.freeBlocks);
+            worstFragmentation = std::max(worstFragmentation, st.externalFragmentation);
+        }
+    }
+    const double totalUs = elapsedUs(t0, BenchClock::now());
+
+    const VRamStats st = allocator.stats();
+    std::cout << "vram " << std::left << std::setw(9) << name << std::right << std::fixed << std::setprecision(1)
+              << " ns/op=" << std::setw(8) << totalUs * 1000.0 / trace.size()
+              << " failures=" << failures
+              << " freeBlocks end/peak=" << st.freeBlocks << "/" << peakFreeBlocks
+              << " largest=" << st.largestFree
+              << " frag end/worst=" << 100.0f * st.externalFragmentation << "%/" << 100.0f * worstFragmentation << "%"
+              << (ok ? "" : " OVERLAP") << "\n";
+    return ok;
+}
+
+// Та же трасса, но как в GpuManager: освобождение отложено на VRAM_ZOMBIE_FRAMES
+// "кадров" (в игре - до fence кадра, см. RetirementQueue), а VRamCompactor раз
+// в кадр переносит меши в дыры.
+// budget = 0 - без уплотнения, для сравнения. Под verify проверяется каждый
+// перенос: источник - текущее место меша, приемник не задевает ни живых, ни зомби.
+constexpr size_t VRAM_TRACE_OPS_PER_FRAME = 256;
+constexpr uint64_t VRAM_ZOMBIE_FRAMES = 3;
+
+static bool replayVRamCompaction(const char* name, const std::vector<VRamTraceOp>& trace, uint32_t capacity,
+                                 uint32_t budget, bool verify) {
+    struct Zombie {
+        uint32_t offset;
+        uint32_t size;
+        uint64_t frame;
+    };
+
+    VRamAllocator allocator(capacity);
+    VRamCompactor compactor;
+    std::vector<uint32_t> offsets(trace.size(), VRAM_ALLOC_FAILED);
+    std::map<uint32_t, uint32_t> occupied; // Живые + зомби (только verify)
+    std::deque<Zombie> zombies;
+    std::vector<VRamMove> moves;
+    uint64_t failures = 0, frame = 0;
+    double planUs = 0.0;
+    float worstFragmentation = 0.0f;
+    bool ok = true;
+
+    auto overlaps = [&](const uint32_t offset, const uint32_t size) {
+        const auto next = occupied.lower_bound(offset);
+        if (next != occupied.end() && next->first < offset + size) return true;
+        return next != occupied.begin() && std::prev(next)->first + std::prev(next)->second > offset;
+    };
+
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const VRamTraceOp& op = trace[i];
+        if (op.alloc) {
+            const uint32_t offset = allocator.allocate(op.size);
+            offsets[op.id] = offset;
+            if (offset == VRAM_ALLOC_FAILED) { ++failures; continue; }
+            if (verify) {
+                if (overlaps(offset, op.size)) ok = false;
+                occupied[offset] = op.size;
+            }
+            compactor.track(offset, op.size, op.id);
+        } else if (offsets[op.id] != VRAM_ALLOC_FAILED) {
+            compactor.untrack(offsets[op.id]);
+            zombies.push_back({offsets[op.id], op.size, frame});
+            offsets[op.id] = VRAM_ALLOC_FAILED;
+        }
+
+        if ((i + 1) % VRAM_TRACE_OPS_PER_FRAME != 0) continue;
+
+        // Конец кадра: как recycleZombies + compactVertices
+        ++frame;
+        while (!zombies.empty() && frame >= zombies.front().frame + VRAM_ZOMBIE_FRAMES) {
+            allocator.free(zombies.front().offset, zombies.front().size);
+            if (verify) occupied.erase(zombies.front().offset);
+            zombies.pop_front();
+        }
+
+        const float fragmentation = allocator.stats().externalFragmentation;
+        worstFragmentation = std::max(worstFragmentation, fragmentation);
+        if (budget == 0 || fragmentation < vramCompactThreshold) continue;
+
+        moves.clear();
+        const auto t0 = BenchClock::now();
+        compactor.plan(allocator, budget, moves);
+        planUs += elapsedUs(t0, BenchClock::now());
+
+        for (const VRamMove& move : moves) {
+            if (verify) {
+                if (offsets[move.owner] != move.from || move.to + move.size > move.from || overlaps(move.to, move.size)) ok = false;
+                occupied[move.to] = move.size;
+            }
+            offsets[move.owner] = move.to;
+            zombies.push_back({move.from, move.size, frame});
+        }
+    }
+
+    const VRamStats st = allocator.stats();
+    const VRamCompactorStats cs = compactor.stats();
+    std::cout << "vram " << std::left << std::setw(9) << name << std::right << std::fixed << std::setprecision(1)
+              << " plan us/frame=" << std::setw(6) << planUs / std::max<uint64_t>(1, frame)
+              << " failures=" << failures
+              << " moves=" << cs.moves << " (" << cs.movedUnits * sizeof(uint32_t) / (1024 * 1024) << " MB)"
+              << " freeBlocks=" << st.freeBlocks
+              << " largest=" << st.largestFree
+              << " frag end/worst=" << 100.0f * st.externalFragmentation << "%/" << 100.0f * worstFragmentation << "%"
+              << (ok ? "" : " BAD MOVE") << "\n";
+    return ok;
+}
+
+static bool benchVRamAllocators(const std::vector<uint32_t>& meshSizes, bool verify) {
+    if (meshSizes.empty()) return true;
+    uint32_t peakLive = 0;
+    const std::vector<VRamTraceOp> trace = buildVRamTrace(meshSizes, peakLive);
+    // Запас 25% сверх пика: с ним first fit еще справляется, но видно дробление
+    const uint32_t capacity = peakLive + peakLive / 4;
+    std::cout << "vram trace: " << trace.size() << " ops, " << VRAM_TRACE_RESIDENT
+              << " resident, peak live=" << peakLive << " capacity=" << capacity << "\n";
+
+    bool ok = replayVRamTrace<VRamAllocator>("tlsf", trace, capacity, verify);
+    ok = replayVRamTrace<FirstFitVRamAllocator>("firstfit", trace, capacity, verify) && ok;
+
+    // Зомби + уплотнение с бюджетом игры
+    const uint32_t budget = static_cast<uint32_t>(vramCompactBudgetKB) * 1024 / sizeof(uint32_t);
+    ok = replayVRamCompaction("zombies", trace, capacity, 0, verify) && ok;
+    ok = replayVRamCompaction("compact", trace, capacity, budget, verify) && ok;
+    return ok;
+}
+
+// Заполнение мира, как при старте игры: чанки приходят от ближних к дальним
+// пачками по CHUNKS_PER_FRAME за "кадр" (16 мс). Сравнивается число задач мешинга
+// без ворот (новый чанк + все загруженные соседи, повторы в кадре сливаются)
+// и через MeshReadiness. Мешинг не запускается - считаются только задачи.
+static void benchMeshGate(const BenchConfig& cfg, const std::vector<std::shared_ptr<Chunk>>& generated) {
+    constexpr size_t CHUNKS_PER_FRAME = 64;
+    const glm::ivec3 offs[] = {{-1,0,0},{1,0,0},{0,-1,0},{0,1,0},{0,0,-1},{0,0,1}};
+    const glm::ivec3 center(0, (cfg.yMin + cfg.yMax) / 2, 0);
+
+    std::vector<std::shared_ptr<Chunk>> order = generated;
+    std::ranges::sort(order, [&](const auto& a, const auto& b) {
+        const glm::ivec3 da = a->worldPosition - center, db = b->worldPosition - center;
+        return da.x*da.x + da.y*da.y + da.z*da.z < db.x*db.x + db.y*db.y + db.z*db.z;
+    });
+
+    const LoadBox box{glm::ivec3(-cfg.radiusXZ, cfg.yMin, -cfg.radiusXZ), glm::ivec3(cfg.radiusXZ, cfg.yMax, cfg.radiusXZ)};
+    ChunkMap naiveMap, gateMap;
+    MeshReadiness gate;
+    std::vector<std::shared_ptr<Chunk>> ready;
+    std::unordered_set<glm::ivec3, GoodVec3Hasher, FastIVec3Equal> dirty;
+    uint64_t naiveJobs = 0, gateJobs = 0;
+    auto now = MeshReadiness::Clock::time_point{};
+
+    for (size_t i = 0; i < order.size() || gate.stats().waiting > 0; i += CHUNKS_PER_FRAME) {
+        const size_t end = std::min(order.size(), i + CHUNKS_PER_FRAME);
+        dirty.clear();
+        for (size_t k = i; k < end; ++k) {
+            const auto& chunk = order[k];
+            const glm::ivec3 pos = chunk->worldPosition;
+
+            naiveMap.insert(pos, chunk);
+            dirty.insert(pos);
+            for (const auto& o : offs) if (naiveMap.contains(pos + o)) dirty.insert(pos + o);
+
+            gateMap.insert(pos, chunk);
+            gate.markDirty(chunk);
+            gate.neighbourArrived(pos);
+            for (const auto& o : offs) {
+                if (auto n = gateMap.tryGet(pos + o)) gate.markDirty(n);
+            }
+        }
+        naiveJobs += dirty.size();
+
+        now += std::chrono::milliseconds(16);
+        ready.clear();
+        gate.collectReady(gateMap, nullptr, box, now, ready);
+        gateJobs += ready.size();
+    }
+
+    const MeshReadinessStats st = gate.stats();
+    std::cout << "mesh gate (world fill): jobs naive=" << naiveJobs << " gated=" << gateJobs
+              << " (" << std::fixed << std::setprecision(2)
+              << (gateJobs ? static_cast<double>(naiveJobs) / static_cast<double>(gateJobs) : 0.0) << "x fewer)"
+              << " merged=" << st.merged << " deferred=" << st.deferred << " timedOut=" << st.timedOut << "\n";
+}
+
+// Масштабирование JobSystem: весь регион генерируется (класс Generation), затем
+// мешится (класс Meshing) на 1, 2, 4 ... cfg.jobs воркерах. Загрузка воркеров
+// ниже ~90% на полном регионе - признак конкуренции за очереди, а не нехватки работы.
+static bool benchJobSystem(const BenchConfig& cfg, const std::vector<glm::ivec3>& region) {
+    auto& jobs = JobSystem::Get();
+    uint64_t referenceQuads = 0;
+    bool ok = true;
+
+    std::vector<int> counts;
+    for (int w = 1; w < cfg.jobs; w *= 2) counts.push_back(w);
+    counts.push_back(cfg.jobs);
+
+    for (const int workers : counts) {
+        jobs.start(static_cast<uint32_t>(workers), cfg.pin);
+
+        ChunkMap chunks;
+        std::vector<std::shared_ptr<Chunk>> generated(region.size());
+        auto t0 = BenchClock::now();
+        for (size_t i = 0; i < region.size(); ++i) {
+            jobs.submit(JobClass::Generation, [&, i] {
+                generated[i] = generateChunkData(region[i]);
+                chunks.insert(region[i], generated[i]);
+            });
+        }
+        jobs.waitIdle();
+        auto t1 = BenchClock::now();
+
+        std::atomic<uint64_t> quads{0};
+        for (const auto& chunk : generated) {
+            jobs.submit(JobClass::Meshing, [&, c = chunk.get()] {
+                MeshHandle mesh = BuildChunkMeshPooled(c, chunks);
+                quads.fetch_add(mesh->quadCount(), std::memory_order_relaxed);
+            });
+        }
+        jobs.waitIdle();
+        auto t2 = BenchClock::now();
+
+        const auto stats = jobs.stats();
+        jobs.stop();
+
+        double minUtil = 1.0, sumUtil = 0.0;
+        uint64_t steals = 0, sleeps = 0;
+        for (const auto& w : stats) {
+            minUtil = std::min(minUtil, w.utilisation);
+            sumUtil += w.utilisation;
+            steals += w.jobsStolen;
+            sleeps += w.sleeps;
+        }
+
+        const double genS = elapsedUs(t0, t1) * 1e-6, meshS = elapsedUs(t1, t2) * 1e-6;
+        std::cout << "jobs x" << std::setw(2) << workers << std::fixed << std::setprecision(1)
+                  << ": gen chunks/s=" << std::setw(9) << region.size() / genS
+                  << " mesh chunks/s=" << std::setw(9) << region.size() / meshS
+                  << " util avg=" << 100.0 * sumUtil / stats.size() << "% min=" << 100.0 * minUtil << "%"
+                  << " steals=" << steals << " sleeps=" << sleeps << "\n";
+
+        // Результат не должен зависеть от числа воркеров
+        if (referenceQuads == 0) referenceQuads = quads;
+        else if (quads != referenceQuads) ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const BenchConfig cfg = parseConfig(argc, argv);
+    worldSeed = cfg.seed;
+    paletteStorage = cfg.palette;
+    mesherType = cfg.mesher;
+    quadFormat = cfg.quads;
+    lodStartDistance = cfg.lodStart;
+
+    std::vector<glm::ivec3> region;
+    for (int x = -cfg.radiusXZ; x <= cfg.radiusXZ; ++x)
+        for (int z = -cfg.radiusXZ; z <= cfg.radiusXZ; ++z)
+            for (int y = cfg.yMin; y <= cfg.yMax; ++y)
+                region.emplace_back(x, y, z);
+
+    std::cout << "cubeBench: " << region.size() << " chunks, seed " << cfg.seed
+              << ", repeat " << cfg.repeat << (cfg.palette ? ", palette storage" : "")
+              << ", " << (cfg.mesher == MesherType::Binary ? "binary" : "scalar") << " mesher"
+              << ", " << (cfg.quads == QuadFormat::Packed32 ? "32" : "64") << "-bit quads\n";
+
+    if (cfg.verify) {
+        bool ok = verifyUpscale(region);
+        ok = verifyClassify(region) && ok;
+        ok = verifyJobRekey() && ok;
+        ok = verifyQueues() && ok;
+        if (!ok) {
+            std::cerr << "cubeBench: kernel verification FAILED\n";
+            return 1;
+        }
+        benchKernels();
+    }
+
+    const bool coarseGenOk = benchCoarseGeneration(region, cfg.verify);
+    const bool columnGenOk = benchColumnGeneration(cfg, cfg.verify);
+
+    StageStats gen{"gen"}, mesh{"mesh"}, pack{"pack"};
+    std::vector<uint32_t> staging; // Эмуляция вершинного SSBO для стадии упаковки
+    uint64_t uniformChunks = 0;    // Чанки без буфера (однородные)
+    bool memoryOk = true;
+    bool mesherOk = true;
+    bool gridOk = true;
+    bool faceCullOk = true;
+    bool quadFormatOk = true;
+    bool lodOk = true;
+    std::vector<uint32_t> meshSizes; // Выровненные размеры непустых мешей (для трассы VRAM)
+
+    for (int r = 0; r < cfg.repeat; ++r) {
+        ChunkMap chunks;
+        std::vector<std::shared_ptr<Chunk>> generated;
+        generated.reserve(region.size());
+
+        // --- 1. Генерация ---
+        auto stageStart = BenchClock::now();
+        for (const auto& pos : region) {
+            auto t0 = BenchClock::now();
+            auto chunk = generateChunkData(pos);
+            auto t1 = BenchClock::now();
+
+            gen.latencyUs.push_back(elapsedUs(t0, t1));
+            gen.outputBytes += chunk->memoryBytes();
+            if (chunk->isUniform()) ++uniformChunks;
+            chunks.insert(pos, chunk);
+            generated.push_back(std::move(chunk));
+        }
+        gen.totalSeconds += elapsedUs(stageStart, BenchClock::now()) * 1e-6;
+        if (r == 0) memoryOk = reportMemory(generated, cfg.verify);
+        if (r == 0 && cfg.verify) mesherOk = verifyMesher(generated, chunks);
+        if (r == 0 && cfg.verify) benchMesherEngines(generated, chunks);
+        if (r == 0) gridOk = benchChunkGrid(cfg, generated, chunks);
+        if (r == 0) faceCullOk = benchFaceCulling(cfg, generated, chunks, cfg.verify);
+        if (r == 0) quadFormatOk = benchQuadFormat(generated, chunks, cfg.verify);
+        if (r == 0) lodOk = benchLod(cfg, generated, chunks, cfg.verify);
+        if (r == 0) benchMeshGate(cfg, generated);
+
+        // --- 2. Мешинг (все соседи уже в карте, как в установившемся режиме) ---
+        // Как в игре: слэбы из MeshBufferPool, без копий до стадии упаковки
+        std::vector<MeshHandle> meshes;
+        meshes.reserve(generated.size());
+        const MeshPoolStats poolBefore = MeshBufferPool::Get().stats();
+
+        stageStart = BenchClock::now();
+        for (const auto& chunk : generated) {
+            auto t0 = BenchClock::now();
+            MeshHandle data = BuildChunkMeshPooled(chunk.get(), chunks);
+            auto t1 = BenchClock::now();
+
+            mesh.latencyUs.push_back(elapsedUs(t0, t1));
+            mesh.quads += data->quadCount();
+            mesh.outputBytes += data->quads.size() * sizeof(uint32_t);
+            if (r == 0 && !data->quads.empty()) {
+                meshSizes.push_back(static_cast<uint32_t>((data->quads.size() + 3) & ~size_t(3)));
+            }
+            meshes.push_back(std::move(data));
+        }
+        mesh.totalSeconds += elapsedUs(stageStart, BenchClock::now()) * 1e-6;
+
+        // --- 3. Упаковка (то же выравнивание, что и в GpuManager::uploadChunk) ---
+        size_t totalAligned = 0;
+        for (const auto& handle : meshes) totalAligned += (handle->quads.size() + 3) & ~size_t(3);
+        staging.assign(totalAligned, 0);
+
+        stageStart = BenchClock::now();
+        size_t cursor = 0;
+        for (const auto& handle : meshes) {
+            const std::vector<uint32_t>& data = handle->quads;
+            auto t0 = BenchClock::now();
+            if (!data.empty()) std::memcpy(staging.data() + cursor, data.data(), data.size() * sizeof(uint32_t));
+            size_t aligned = (data.size() + 3) & ~size_t(3);
+            cursor += aligned;
+            auto t1 = BenchClock::now();
+
+            pack.latencyUs.push_back(elapsedUs(t0, t1));
+            pack.quads += handle->quadCount();
+            pack.outputBytes += aligned * sizeof(uint32_t);
+        }
+        pack.totalSeconds += elapsedUs(stageStart, BenchClock::now()) * 1e-6;
+
+        // Слэбы возвращаются в пул; со второго прохода новых слэбов быть не должно
+        meshes.clear();
+        const MeshPoolStats poolAfter = MeshBufferPool::Get().stats();
+        std::cout << "mesh pool pass " << r << ": acquired=" << poolAfter.acquired - poolBefore.acquired
+                  << " new slabs=" << poolAfter.slabsCreated - poolBefore.slabsCreated
+                  << " growths=" << poolAfter.slabGrowths - poolBefore.slabGrowths
+                  << " trimmed=" << poolAfter.slabsTrimmed - poolBefore.slabsTrimmed
+                  << " pooled=" << poolAfter.pooled << " live=" << poolAfter.live << "\n";
+    }
+
+    printStage(gen);
+    printStage(mesh);
+    printStage(pack);
+    std::cout << "uniform chunks: " << uniformChunks << " / " << gen.latencyUs.size() << "\n";
+    if (!memoryOk) {
+        std::cerr << "cubeBench: palette round-trip FAILED\n";
+        return 1;
+    }
+    if (!gridOk) {
+        std::cerr << "cubeBench: ChunkGrid disagrees with ChunkMap\n";
+        return 1;
+    }
+    if (!mesherOk) {
+        std::cerr << "cubeBench: binary mesher differs from scalar\n";
+        return 1;
+    }
+    if (!faceCullOk) {
+        std::cerr << "cubeBench: face ranges or face culling mask are wrong\n";
+        return 1;
+    }
+    if (!quadFormatOk) {
+        std::cerr << "cubeBench: 32-bit quads do not decode to the 64-bit mesh\n";
+        return 1;
+    }
+    if (!coarseGenOk) {
+        std::cerr << "cubeBench: coarse generation does not sample the low-res noise grid\n";
+        return 1;
+    }
+    if (!columnGenOk) {
+        std::cerr << "cubeBench: column generation differs from per-chunk noise classified top-down\n";
+        return 1;
+    }
+    if (!lodOk) {
+        std::cerr << "cubeBench: LOD meshes are not cell-aligned or LOD selection flips back\n";
+        return 1;
+    }
+    if (!benchVRamAllocators(meshSizes, cfg.verify)) {
+        std::cerr << "cubeBench: VRAM allocator or compactor handed out overlapping blocks\n";
+        return 1;
+    }
+    if (cfg.jobs > 0 && !benchJobSystem(cfg, region)) {
+        std::cerr << "cubeBench: JobSystem results depend on worker count\n";
+        return 1;
+    }
+    return 0;
+}
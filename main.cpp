@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <iostream>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <future>
 #include <glad/glad.h>
@@ -32,14 +33,27 @@ import FPSCounter;
 import Window;
 import CreateShader;
 import GpuManager;
+import ChunkMesher;
+import MeshBufferPool;
 import Chunk;
+import ChunkGrid;
+import LockFreeQueue;
+import MeshReadiness;
 import VramAllocator;
+import RetirementQueue;
+import JobSystem;
 import Frustum;
+import FrameBudget;
+import FaceCulling;
+import ChunkLod;
 
 // Структура задачи загрузки (локальная для Main Thread)
+// Готовых мешей в пути к главному потоку (при переполнении воркер ждет места)
+constexpr size_t UPLOAD_QUEUE_CAPACITY = 4096;
+
 struct UploadTask {
     std::shared_ptr<Chunk> chunk;
-    std::vector<uint32_t> data;
+    MeshHandle mesh; // Слэб из MeshBufferPool, возвращается в пул после загрузки
 };
 
 class SimpleFramebuffer {
@@ -124,7 +138,7 @@ public:
     bool onGround = false;
     double timeCollector = 0;
 
-    VoxelGame() : threadPool(std::thread::hardware_concurrency() / 2) {
+    VoxelGame() {
         window = new Window(camera,"My Game");
         programIsRunning = true;
         physic_ = new Physic(camera);
@@ -158,13 +172,13 @@ public:
 
         gpuManager = std::make_unique<GpuManager>(renderDistanceXZ+3,(renderHeightY+2)*2);
 
-        // Запуск потоков
-        int workers = std::max(1u, std::thread::hardware_concurrency() - 2); // Оставим пару ядер системе
-        for(int i = 0; i < workers; ++i) {
-            workerThreads.emplace_back(chunkWorker);
-        }
+        // Запуск потоков: генерация и мешинг делят один пул воркеров (см. Config.h)
+        JobSystem::Get().start(static_cast<uint32_t>(std::max(0, jobWorkerCount)), pinJobWorkers);
+        // Генерация за радиусом отмены не нужна; мешинг только понижается (чанк еще в карте).
+        // Радиус - зона хранения поисковика, отмененное внутри зоны загрузки он ставит заново
+        JobSystem::Get().setCancelRadius(JobClass::Generation, static_cast<float>(renderDistanceXZ + 2));
 
-        finderThread = std::thread(chunkFinder, std::ref(loadedChunks));
+        finderThread = std::thread(chunkFinder, std::cref(loadedChunks), std::cref(chunkGrid));
 
         camera.pos = glm::vec3(16, 40, -40);
 
@@ -176,6 +190,60 @@ public:
 
     void Run() {
         FPSCounterAdvanced fpsCounter;
+        // Глубина хвостов: если растет - бюджеты малы для текущей скорости игрока
+        fpsCounter.extraInfo = [this](std::ostream& os) {
+            os << " | Backlog gen/mesh/upload: " << newChunkBacklog.size()
+               << "/" << chunksToMeshQueue.size() << "/" << uploadBacklog.size()
+               << " | Finder load/unload: " << finderStats.pendingLoads.load(std::memory_order_relaxed)
+               << "/" << finderStats.unloadCandidates.load(std::memory_order_relaxed)
+               << " (" << finderStats.lastTickUs.load(std::memory_order_relaxed) << "us, requeued "
+               << finderStats.requeued.load(std::memory_order_relaxed) << ")";
+
+            // Загрузка воркеров за интервал заголовка: средняя и самая ленивая/занятая
+            auto& jobs = JobSystem::Get();
+            const auto workers = jobs.stats();
+            if (!workers.empty()) {
+                double sum = 0.0, lo = 1.0, hi = 0.0;
+                for (const auto& w : workers) {
+                    sum += w.utilisation;
+                    lo = std::min(lo, w.utilisation);
+                    hi = std::max(hi, w.utilisation);
+                }
+                os << " | Jobs x" << workers.size() << ": " << int(100.0 * sum / workers.size())
+                   << "% (" << int(100.0 * lo) << "-" << int(100.0 * hi) << "%)";
+                const JobQueueStats q = jobs.queueStats();
+                os << " demoted/cancelled: " << q.demoted << "/" << q.cancelled;
+                jobs.resetStats();
+            }
+
+            // Сколько воркеры прождали места в очередях к главному потоку (с начала игры)
+            const QueueStats voxelQ = voxelDataQueue.stats(), uploadQ = uploadQueue.stats();
+            os << " | Queue depth/wait gen " << voxelQ.depth << "/" << int(voxelQ.waitUs / 1000.0) << "ms"
+               << " upload " << uploadQ.depth << "/" << int(uploadQ.waitUs / 1000.0) << "ms";
+
+            // Заполненность вершинного буфера и его раздробленность
+            const VRamStats vram = gpuManager->getVRamStats();
+            os << " | VRAM " << int(100.0f * vram.used / std::max(1u, vram.capacity)) << "% frag "
+               << int(100.0f * vram.externalFragmentation) << "% (" << vram.freeBlocks << " free)"
+               << " compacted " << gpuManager->getCompactorStats().moves;
+
+            // Формат квадов: байт на квад с палитрами и выравниванием, чанки Packed32/Wide64
+            const MeshFormatStats meshes = gpuManager->getMeshFormatStats();
+            os << " | Quads " << meshes.quads << " @ "
+               << int(100.0 * meshes.bytes / std::max<uint64_t>(1, meshes.quads)) / 100.0 << " B"
+               << " (32/64: " << meshes.packedChunks << "/" << meshes.wideChunks << ")";
+
+            // Кадры с освобождениями, которые GPU еще не прошел
+            const RetirementStats retire = gpuManager->getRetirementStats();
+            os << " | Retire pending " << retire.framesPending << " (full waits " << retire.ringFullWaits << ")";
+
+            // Ждут соседей / пометок слито без лишнего меша (с начала игры)
+            const MeshReadinessStats gate = meshGate.stats();
+            os << " | Mesh gate wait/merged: " << gate.waiting << "/" << gate.merged;
+
+            // Перемешиваний из-за смены LOD (с начала игры)
+            os << " | LOD remeshes " << lodRemeshes << " promotions " << lodPromotions;
+        };
 
         while (!glfwWindowShouldClose(window->window)) {
             // 1. Обновление позиции для генератора
@@ -183,10 +251,14 @@ public:
                 std::lock_guard lock(playerPosMutex);
                 currentPlayerChunk = glm::floor(camera.pos / 32.0);
             }
+            // Новая эпоха ключей в очередях задач (если игрок сменил чанк или повернулся)
+            JobSystem::Get().setView(currentPlayerChunk, camera.camera->forward());
+            UpdateChunkGrid();
 
             // 2. Логика чанков
             ProcessNewChunks();
             ProcessUnloadQueue();
+            UpdateChunkLods();
             ScheduleMeshing();
             UploadToGPU();
 
@@ -204,22 +276,37 @@ private:
     std::vector<std::shared_ptr<Chunk>> chunksToMeshQueue;
     Camera camera;
     ChunkMap loadedChunks;
+    // Зеркало loadedChunks вокруг игрока для горячих путей (мешер, физика, поисковик)
+    ChunkGrid chunkGrid{renderDistanceXZ, renderHeightY};
+    std::vector<std::shared_ptr<Chunk>> enteredChunks; // Чанки вошедшего слоя окна (UpdateChunkGrid)
+    MeshReadiness meshGate;
+    std::vector<std::shared_ptr<Chunk>> readyToMesh;
     Physic *physic_;
-    PriorityThreadPool threadPool;
     std::unique_ptr<GpuManager> gpuManager;
 
     GLuint renderProgram = 0;
     GLuint computeProgram = 0;
     GLuint texture = 0;
 
-    std::vector<std::thread> workerThreads;
     std::thread finderThread;
 
     SimpleFramebuffer renderFbo;
     float renderScale = 1.0f;
 
-    std::vector<UploadTask> uploadQueue;
-    std::mutex uploadMutex;
+    // Воркеры -> главный поток, без блокировок (см. LockFreeQueue)
+    MpmcQueue<UploadTask> uploadQueue{UPLOAD_QUEUE_CAPACITY};
+    std::vector<glm::ivec3> unloadBatch;
+
+    // Бюджеты стадий главного потока (мкс на кадр, см. Config.h) и их хвосты.
+    // Хвосты живут только в главном потоке и отсортированы: ближайший - в конце.
+    StageBudget newChunksBudget, meshScheduleBudget, uploadBudget;
+    std::vector<std::shared_ptr<Chunk>> newChunkBacklog;
+    std::vector<UploadTask> uploadBacklog;
+    glm::ivec3 backlogSortChunk{INT32_MAX}; // Позиция игрока при последней сортировке хвостов
+    glm::ivec3 gridCenter{INT32_MAX};       // Центр окна chunkGrid
+    glm::ivec3 lodCenter{INT32_MAX};        // Позиция игрока при последнем пересчете LOD
+    uint64_t lodRemeshes = 0;
+    uint64_t lodPromotions = 0; // Прореженных чанков, поставленных на полную генерацию
 
     // renderList больше не нужен для отрисовки, но оставим для совместимости логики
     std::vector<Chunk*> renderList;
@@ -290,67 +377,164 @@ private:
         glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
     }
 
-    void ProcessNewChunks() {
-        std::vector<std::shared_ptr<Chunk>> batch = changedChunks;
-        changedChunks.clear();
-        {
-            std::lock_guard lock(voxelDataMutex);
-            int count = 0;
-            while (!voxelDataQueue.empty() && count++ < 256) {
-                batch.push_back(voxelDataQueue.front());
-                voxelDataQueue.pop();
-            }
-        }
+    // Дальние в начале, ближайший в конце: берем через pop_back
+    template <typename T, typename GetPos>
+    void SortFarthestFirst(std::vector<T>& items, GetPos getPos) {
+        glm::vec3 pPos = camera.pos;
+        std::ranges::sort(items, [&](const T& a, const T& b) {
+            float distA = glm::distance2(glm::vec3(getPos(a) * 32 + 16), pPos);
+            float distB = glm::distance2(glm::vec3(getPos(b) * 32 + 16), pPos);
+            return distA > distB;
+        });
+    }
 
-        for (auto& newChunk : batch) {
-            auto oldChunk = loadedChunks.tryGet(newChunk->worldPosition);
+    void IntegrateChunk(const std::shared_ptr<Chunk>& newChunk, const bool isEdit = false) {
+        auto oldChunk = loadedChunks.tryGet(newChunk->worldPosition);
 
-            if (oldChunk && oldChunk == newChunk) {
-                // Обновление существующего
-            }
-            else {
-                if (oldChunk) {
-                    RemoveFromRenderList(oldChunk.get());
-                    gpuManager->freeChunk(oldChunk.get());
-                    loadedChunks.erase(newChunk->worldPosition);
-                }
-                loadedChunks.insert(newChunk->worldPosition, newChunk);
+        if (oldChunk && oldChunk == newChunk) {
+            // Обновление существующего
+        }
+        else {
+            if (oldChunk && oldChunk->renderInfo && newChunk->genLod < oldChunk->genLod) {
+                // Полная генерация пришла на смену прореженной: слот и меш переходят
+                // к новому чанку и остаются на экране, пока не загрузится новый меш
+                newChunk->renderInfo = std::exchange(oldChunk->renderInfo, nullptr);
+                newChunk->meshLod = oldChunk->meshLod;
+                RemoveFromRenderList(oldChunk.get());
+                AddToRenderList(newChunk.get());
+                chunkGrid.remove(oldChunk.get());
+                loadedChunks.erase(newChunk->worldPosition);
+            } else if (oldChunk) {
+                RemoveFromRenderList(oldChunk.get());
+                gpuManager->freeChunk(oldChunk.get());
+                chunkGrid.remove(oldChunk.get());
+                loadedChunks.erase(newChunk->worldPosition);
             }
+            loadedChunks.insert(newChunk->worldPosition, newChunk);
+            chunkGrid.publish(newChunk);
+        }
 
+        // Меш - через ворота готовности: чанк подождет соседей, а повторные
+        // пометки (каждый пришедший сосед) сольются в одну задачу. Правку игрока
+        // мешим сразу, ей соседи не нужны: они уже загружены или не придут.
+        if (isEdit) {
+            meshGate.forget(newChunk->worldPosition);
             if (!newChunk->needsMeshUpdate) {
                 newChunk->needsMeshUpdate = true;
                 chunksToMeshQueue.push_back(newChunk);
             }
+        } else {
+            meshGate.markDirty(newChunk, newChunk->needsMeshUpdate);
+        }
+        meshGate.neighbourArrived(newChunk->worldPosition);
 
-            const glm::ivec3 offs[] = {{-1,0,0},{1,0,0},{0,-1,0},{0,1,0},{0,0,-1},{0,0,1}};
-            for(auto& o : offs) {
-                if(auto n = loadedChunks.tryGet(newChunk->worldPosition + o)) {
-                    if (!n->needsMeshUpdate) {
-                        n->needsMeshUpdate = true;
-                        chunksToMeshQueue.push_back(n);
-                    }
-                }
+        const glm::ivec3 offs[] = {{-1,0,0},{1,0,0},{0,-1,0},{0,1,0},{0,0,-1},{0,0,1}};
+        for(auto& o : offs) {
+            if(auto n = loadedChunks.tryGet(newChunk->worldPosition + o)) {
+                meshGate.markDirty(n, n->needsMeshUpdate);
             }
+        }
+        {
             std::lock_guard glock(generationMutex);
             pendingGeneration.erase(newChunk->worldPosition);
         }
+
+        // Прореженный чанк пришел, когда игрок уже рядом
+        PromoteIfNeeded(*newChunk, selectLod(chunkRing(newChunk->worldPosition, currentPlayerChunk), 0));
     }
 
-    void ProcessUnloadQueue() {
-        std::vector<glm::ivec3> batch;
-        {
-            std::lock_guard lock(unloadMutex);
-            while(!unloadQueue.empty()) {
-                batch.push_back(unloadQueue.front());
-                unloadQueue.pop();
+    // Чанку нужен LOD детальнее, чем у его блоков: ставим полную генерацию
+    void PromoteIfNeeded(const Chunk& chunk, const int wantedLod) {
+        if (wantedLod >= chunk.genLod) return;
+        if (requestFullGeneration(chunk.worldPosition)) lodPromotions++;
+    }
+
+    // Сдвигает окно сетки за игроком. Чанки, которые при загрузке были вне окна,
+    // публикуются, как только в него попадают.
+    void UpdateChunkGrid() {
+        chunkGrid.collectRetired();
+        if (gridCenter == currentPlayerChunk) return;
+        gridCenter = currentPlayerChunk;
+        // Вошедшие чанки публикуются до того, как читатели увидят новое окно.
+        // Только слой разности окон: одним пакетным запросом к карте, без обхода всей карты
+        chunkGrid.setCenter(gridCenter, [this](const std::vector<glm::ivec3>& entered) {
+            enteredChunks.resize(entered.size());
+            loadedChunks.tryGetMany(entered.data(), enteredChunks.data(), entered.size());
+            for (const auto& chunk : enteredChunks) {
+                if (chunk) chunkGrid.publish(chunk);
             }
+            enteredChunks.clear(); // Владение - у карты и сетки
+        });
+    }
+
+    // Игрок сменил чанк: смешанные чанки, чей LOD по кольцу поменялся, - в мешинг,
+    // прореженные при генерации чанки, к которым игрок подошел, - на полную генерацию.
+    // Сам LOD выбирается в ScheduleMeshing (с гистерезисом от Chunk::meshLod).
+    void UpdateChunkLods() {
+        if (lodCenter == currentPlayerChunk) return;
+        lodCenter = currentPlayerChunk;
+        if (lodStartDistance <= 0) return;
+
+        for (Chunk* chunk : renderList) {
+            const int wanted = selectLod(chunkRing(chunk->worldPosition, currentPlayerChunk), chunk->meshLod);
+            PromoteIfNeeded(*chunk, wanted);
+            if (chunk->needsMeshUpdate) continue;
+            if (std::max<int>(wanted, chunk->genLod) == chunk->meshLod) continue;
+            auto shared = loadedChunks.tryGet(chunk->worldPosition);
+            if (shared.get() != chunk) continue;
+            shared->needsMeshUpdate = true;
+            chunksToMeshQueue.push_back(std::move(shared));
+            lodRemeshes++;
+        }
+    }
+
+    void ProcessNewChunks() {
+        // Правки игрока - первыми и вне бюджета: их должно быть видно сразу
+        std::vector<std::shared_ptr<Chunk>> edits;
+        edits.swap(changedChunks);
+        for (auto& chunk : edits) IntegrateChunk(chunk, true);
+
+        const bool arrived = voxelDataQueue.popBatch(newChunkBacklog) > 0;
+        if (arrived || backlogSortChunk != currentPlayerChunk) {
+            SortFarthestFirst(newChunkBacklog, [](const std::shared_ptr<Chunk>& c) { return c->worldPosition; });
+        }
+
+        newChunksBudget.begin(newChunksBudgetUs);
+        while (!newChunkBacklog.empty() && newChunksBudget.canTake()) {
+            auto t0 = StageBudget::now();
+            IntegrateChunk(newChunkBacklog.back());
+            newChunkBacklog.pop_back();
+            newChunksBudget.record(t0);
         }
+        newChunksBudget.end();
 
-        for(auto& pos : batch) {
+        ReleaseReadyMeshes();
+    }
+
+    // Чанки, дождавшиеся соседей (или таймаута), - в очередь мешинга
+    void ReleaseReadyMeshes() {
+        const glm::ivec3 reach(renderDistanceXZ, renderHeightY, renderDistanceXZ);
+        const LoadBox box{currentPlayerChunk - reach, currentPlayerChunk + reach};
+        readyToMesh.clear();
+        meshGate.collectReady(loadedChunks, &chunkGrid, box, MeshReadiness::Clock::now(), readyToMesh);
+        for (auto& chunk : readyToMesh) {
+            if (chunk->needsMeshUpdate) continue;
+            chunk->needsMeshUpdate = true;
+            chunksToMeshQueue.push_back(std::move(chunk));
+        }
+    }
+
+    void ProcessUnloadQueue() {
+        unloadBatch.clear();
+        unloadQueue.popBatch(unloadBatch);
+
+        for(auto& pos : unloadBatch) {
             auto ptr = loadedChunks.tryGet(pos);
             if(ptr) {
                 RemoveFromRenderList(ptr.get());
                 gpuManager->freeChunk(ptr.get());
+                chunkGrid.remove(ptr.get());
+                meshGate.forget(pos);
                 loadedChunks.erase(pos);
             }
         }
@@ -368,39 +552,71 @@ private:
                           }
         );
 
-        for(auto& chunk : chunksToMeshQueue) {
+        // Ближние первыми, пока хватает бюджета; остальные остаются в очереди
+        // с needsMeshUpdate = true и уйдут в следующих кадрах
+        size_t taken = 0;
+        meshScheduleBudget.begin(meshScheduleBudgetUs);
+        for(; taken < chunksToMeshQueue.size() && meshScheduleBudget.canTake(); ++taken) {
+            auto& chunk = chunksToMeshQueue[taken];
             if(chunk->needsMeshUpdate) {
+                auto t0 = StageBudget::now();
                 chunk->needsMeshUpdate = false;
-                glm::vec3 cPos = glm::vec3(chunk->worldPosition * 32 + 16);
-                int priority = (int)glm::distance2(cPos, pPos);
                 const std::shared_ptr<Chunk>& sharedPtr = chunk;
+                // Дальние кольца - прореженным объемом (ChunkLod), но не детальнее самих блоков
+                const int lod = std::max<int>(selectLod(chunkRing(chunk->worldPosition, currentPlayerChunk), chunk->meshLod),
+                                              chunk->genLod);
+                chunk->meshLod = static_cast<uint8_t>(lod);
 
-                threadPool.enqueue(priority, [this, sharedPtr]() {
+                JobSystem::Get().submit(JobClass::Meshing, sharedPtr->worldPosition, [this, sharedPtr, lod]() {
                     if(!programIsRunning) return;
                     if (!loadedChunks.contains(sharedPtr->worldPosition)) return;
 
-                    auto mesh = BuildChunkMesh(sharedPtr.get(), loadedChunks);
+                    MeshHandle mesh = BuildChunkMeshPooled(sharedPtr.get(), loadedChunks, &chunkGrid, lod);
 
-                    std::lock_guard lock(uploadMutex);
-                    uploadQueue.push_back({sharedPtr, std::move(mesh)});
+                    // При выключении главный поток очередь не разгребает - не ждем вечно
+                    uploadQueue.push({sharedPtr, std::move(mesh)}, [] { return !running; });
                 });
+                meshScheduleBudget.record(t0);
             }
         }
-        chunksToMeshQueue.clear();
+        meshScheduleBudget.end();
+        chunksToMeshQueue.erase(chunksToMeshQueue.begin(), chunksToMeshQueue.begin() + taken);
     }
 
     void UploadToGPU() {
-        std::lock_guard lock(uploadMutex);
-        int uploaded = 0;
-        for(auto it = uploadQueue.begin(); it != uploadQueue.end(); ) {
-            auto existing = loadedChunks.tryGet(it->chunk->worldPosition);
-            if(existing && existing == it->chunk) {
-                gpuManager->uploadChunk(it->chunk.get(), it->data);
-                AddToRenderList(it->chunk.get());
+        const bool arrived = uploadQueue.popBatch(uploadBacklog) > 0;
+        if (arrived || backlogSortChunk != currentPlayerChunk) {
+            SortFarthestFirst(uploadBacklog, [](const UploadTask& t) { return t.chunk->worldPosition; });
+        }
+        backlogSortChunk = currentPlayerChunk;
+
+        // Понемногу сдвигаем меши в дыры внизу пула. До загрузок кадра: все вершины
+        // в пуле уже ушли прошлыми flush'ами, а перенос метаданных уйдет тем же
+        // flushUploads, что и загрузки (одна копия из кольца за кадр).
+        gpuManager->compactVertices(static_cast<size_t>(vramCompactBudgetKB) * 1024);
+
+        // Цена загрузки растет с размером меша: вес = 1 + слов/1024 (копируются байты,
+        // так что квад Packed32 стоит вдвое дешевле Wide64)
+        uploadBudget.begin(uploadBudgetUs);
+        while (!uploadBacklog.empty()) {
+            const double weight = 1.0 + static_cast<double>(uploadBacklog.back().mesh->quads.size()) / 1024.0;
+            if (!uploadBudget.canTake(weight)) break;
+
+            auto t0 = StageBudget::now();
+            UploadTask task = std::move(uploadBacklog.back());
+            uploadBacklog.pop_back();
+
+            auto existing = loadedChunks.tryGet(task.chunk->worldPosition);
+            if(existing && existing == task.chunk) {
+                gpuManager->uploadChunk(task.chunk.get(), *task.mesh);
+                AddToRenderList(task.chunk.get());
             }
-            it = uploadQueue.erase(it);
-            if(++uploaded > 256) break;
+            uploadBudget.record(t0, weight);
         }
+        uploadBudget.end();
+
+        // Все вершины и метаданные кадра - парой копий из кольца
+        gpuManager->flushUploads();
     }
 
     void RenderFrame() {
@@ -413,7 +629,7 @@ private:
         const double dt = (std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() - timeCollector) / 1000;
         timeCollector = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 
-        physic_->makeTick(keyboard_control,changedChunks,camera,dt,loadedChunks,*window);
+        physic_->makeTick(keyboard_control,changedChunks,camera,dt,loadedChunks,chunkGrid,*window);
 
         // 1. Подготовка FBO
         int winWidth, winHeight;
@@ -460,7 +676,9 @@ private:
         glUniform4fv(glGetUniformLocation(computeProgram, "frustumPlanes"), 6, &frustum.planes[0][0]);
         glUniformMatrix4fv(glGetUniformLocation(computeProgram, "viewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
         glUniform3f(glGetUniformLocation(computeProgram, "camPos"), camera.pos.x, camera.pos.y, camera.pos.z);
-        glUniform1ui(glGetUniformLocation(computeProgram, "totalChunks"), gpuManager->maxChunksCapacity);
+        // Только слоты с мешем (activeIndexBuffer), а не вся емкость
+        const uint32_t activeChunks = gpuManager->activeChunkCount();
+        glUniform1ui(glGetUniformLocation(computeProgram, "totalChunks"), activeChunks);
 
         // Bindings:
         // 0: Chunk Metadata (Read)
@@ -469,13 +687,15 @@ private:
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, gpuManager->indirectContext.commandBuffer);
         // 4: Parameter Buffer (Atomic Counter)
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, gpuManager->parameterBuffer);
+        // 5: Active Slots (Read)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, gpuManager->activeIndexBuffer);
 
-        // Запуск: 1 поток на 1 чанк (группы по 64)
-        int numGroups = (gpuManager->maxChunksCapacity + 63) / 64;
+        // Запуск: 1 поток на 1 активный чанк (группы по 64)
+        const GLuint numGroups = (activeChunks + 63) / 64;
 
         glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 
-        glDispatchCompute(numGroups, 1, 1);
+        if (numGroups > 0) glDispatchCompute(numGroups, 1, 1);
 
         // ==========================================
         // ЭТАП 2: БАРЬЕР
@@ -513,7 +733,7 @@ private:
         glMultiDrawArraysIndirectCount(GL_TRIANGLE_STRIP,
                                        0, // offset in commands
                                        0, // offset in count buffer
-                                       gpuManager->maxChunksCapacity, // max draw count
+                                       static_cast<GLsizei>(activeChunks * FACE_COUNT), // max draw count: до 6 направлений на чанк
                                        0  // stride
         );
 
@@ -525,20 +745,12 @@ private:
         programIsRunning = false;
         running = false;
 
-        // 2. Будим ВСЕ потоки, чтобы они вышли из wait()
-        // Важно: если у вас есть generationCV и meshingCV, будите оба
-        generationCV.notify_all();
-
-        // Если в ChunkGenerationManager есть свои очереди с mutex/cv,
-        // убедитесь, что они тоже получают сигнал остановки.
-
-        // 3. Ждем завершения потоков
-        for(auto& t : workerThreads) {
-            if(t.joinable()) t.join();
-        }
+        // 2-3. Сначала поисковик (он ставит задачи), затем пул: оставшиеся задачи
+        // видят running == false и выходят сразу, не трогая карту чанков
         if(finderThread.joinable()) {
             finderThread.join();
         }
+        JobSystem::Get().stop();
 
         // 4. !!! ВАЖНО !!! Уничтожаем GPU ресурсы ПОКА ЕСТЬ КОНТЕКСТ (Window)
         // Если уничтожить window первым, деструктор gpuManager упадет или зависнет драйвер.
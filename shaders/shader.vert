@@ -5,13 +5,14 @@ struct ChunkMetadata {
     uint instanceCount;
     uint first;
     uint number;
-    int pad1, pad2;
+    uint faceQuads[3]; // Квадов направления f: (faceQuads[f / 2] >> (16 * (f % 2))) & 0xFFFF
+    uint paletteWords; // 0 - квады по 2 uint; иначе по 1 uint, за ними палитра блоков (4 ID на uint)
 };
 
 // Читаем метаданные (позицию чанка берем отсюда)
 layout(std430, binding = 0) readonly restrict buffer Chunks { ChunkMetadata chunks[]; };
-// Читаем геометрию (uvec2)
-layout(std430, binding = 2) readonly restrict buffer AllData { uvec2 allData[]; };
+// Читаем геометрию: по 2 uint на квад (Wide64) или по 1 + палитра (Packed32)
+layout(std430, binding = 2) readonly restrict buffer AllData { uint allWords[]; };
 
 uniform mat4 viewProjection;
 uniform vec3 cameraPos;
@@ -23,25 +24,45 @@ out vec3 uv;
 const vec2 quadCornerUV[4] = vec2[](vec2(0,0), vec2(1,0), vec2(0,1), vec2(1,1));
 
 void main() {
-    // 1. Получаем метаданные чанка по gl_BaseInstance (который заполнил Compute Shader)
-    ChunkMetadata chunk = chunks[gl_BaseInstance];
+    // 1. Получаем метаданные чанка по gl_BaseInstance (который заполнил Compute Shader):
+    // младшие 29 бит - слот, старшие 3 - направление диапазона
+    ChunkMetadata chunk = chunks[gl_BaseInstance & 0x1FFFFFFF];
+    uint rangeFace = uint(gl_BaseInstance) >> 29u;
 
-    // 2. Получаем данные вершины
-    uint dataIndex = (chunk.first / 2) + gl_InstanceID;
-    uvec2 data = allData[dataIndex];
-    uint low = data.x;
-    uint high = data.y;
+    // 2. Получаем данные вершины. Команда рисует один диапазон направления:
+    // его начало (в квадах) пришло через first команды, т.е. gl_VertexID = 4 * начало + угол
+    uint quadIndex = uint(gl_VertexID) / 4u + uint(gl_InstanceID);
 
     // --- 3. РАСПАКОВКА ПАРАМЕТРОВ ВОКСЕЛЯ ---
+    // X, Y, Z, W-1, H-1 в обоих форматах лежат в младших словах одинаково,
+    // только в Packed32 размеры сдвинуты на 3 бита вниз (нет поля грани)
+    uint low;
+    uint face;
+    uint blockId;
+    uint sizeShift;
+    if (chunk.paletteWords == 0u) {
+        uint dataIndex = chunk.first + quadIndex * 2u;
+        low = allWords[dataIndex];
+        uint high = allWords[dataIndex + 1u];
+        face = (low >> 15) & 7u;
+        sizeShift = 18u;
+        // Распаковка BlockID (разбит между low и high)
+        blockId = (low >> 28u) | ((high & 15u) << 4u);
+    } else {
+        low = allWords[chunk.first + quadIndex];
+        face = rangeFace;
+        sizeShift = 15u;
+        // Индекс палитры (7 бит) -> байт в словах палитры за квадами
+        uint pal = low >> 25u;
+        uint word = allWords[chunk.first + chunk.instanceCount + (pal >> 2u)];
+        blockId = (word >> ((pal & 3u) * 8u)) & 0xFFu;
+    }
+
     float x = float((low >> 0) & 31u);
     float y = float((low >> 5) & 31u);
     float z = float((low >> 10) & 31u);
-    uint face = (low >> 15) & 7u;
-    float w = float(((low >> 18) & 31u) + 1u);
-    float h = float(((low >> 23) & 31u) + 1u);
-
-    // Распаковка BlockID (разбит между low и high)
-    uint blockId = (low >> 28u) | ((high & 15u) << 4u);
+    float w = float(((low >> sizeShift) & 31u) + 1u);
+    float h = float(((low >> (sizeShift + 5u)) & 31u) + 1u);
 
     // --- 4. РАСЧЕТ ПОЗИЦИИ ЧАНКА (ИСПРАВЛЕНИЕ 2) ---
     // Мы не распаковываем dx/dy/dz, так как вершины статичны.